@@ -21,11 +21,25 @@ function Build_C_code()
         mexopts(end+1) = {'-largeArrayDims'};
     end
 
+    % OpenMP compiler and linker flags. These are only added for the MEX 
+    % functions that have parallel loops. The default compiler on macOS
+    % (clang) does not support OpenMP and so these are built serially.
+    if ispc
+        ompopts = {'COMPFLAGS=$COMPFLAGS /openmp'};
+    elseif ismac
+        ompopts = {};
+    else
+        ompopts = {'CFLAGS=$CFLAGS -fopenmp' 'LDFLAGS=$LDFLAGS -fopenmp'};
+    end
+
     % invoke MEX compilation tool
     if ispc
         mex(mexopts{:},'algorithms\models\TransferNoise\ForcingTransformation\forcingTransform_soilMoisture.c');
         mex(mexopts{:},'algorithms\models\TransferNoise\doIRFconvolution.c');
         mex(mexopts{:},'algorithms\models\ExpSmooth\doExpSmoothing.c');
+        mex(mexopts{:},ompopts{:},'algorithms\calibration\DREAM\DREAM_generation.c');
+        mex(mexopts{:},'algorithms\utilities\timeSeriesStore.c');
+        mex(mexopts{:},ompopts{:},'algorithms\outlierDetection\doDataQualityScreening.c');
                
         delete('algorithms\models\TransferNoise\doIRFconvolution.mexw64');
         delete('algorithms\models\TransferNoise\ForcingTransformation\forcingTransform_soilMoisture.mexw64');
@@ -34,19 +48,31 @@ function Build_C_code()
         movefile('doIRFconvolution.mexw64', 'algorithms\models\TransferNoise','f');
         movefile('forcingTransform_soilMoisture.mexw64', 'algorithms\models\TransferNoise\ForcingTransformation','f');
         movefile('doExpSmoothing.mexw64', 'algorithms\models\ExpSmooth','f');
+        movefile('DREAM_generation.mexw64', 'algorithms\calibration\DREAM','f');
+        movefile('timeSeriesStore.mexw64', 'algorithms\utilities','f');
+        movefile('doDataQualityScreening.mexw64', 'algorithms\outlierDetection','f');
     else        
         mex(mexopts{:},'algorithms/models/TransferNoise/ForcingTransformation/forcingTransform_soilMoisture.c');
         mex(mexopts{:},'algorithms/models/TransferNoise/doIRFconvolution.c');        
         mex(mexopts{:},'algorithms/models/ExpSmooth/doExpSmoothing.c');
+        mex(mexopts{:},ompopts{:},'algorithms/calibration/DREAM/DREAM_generation.c');
+        mex(mexopts{:},'algorithms/utilities/timeSeriesStore.c');
+        mex(mexopts{:},ompopts{:},'algorithms/outlierDetection/doDataQualityScreening.c');
 
         if ismac
             movefile('doIRFconvolution.mexmaci64', 'algorithms/models/TransferNoise','f');
             movefile('forcingTransform_soilMoisture.mexmaci64', 'algorithms/models/TransferNoise/ForcingTransformation','f');
             movefile('doExpSmoothing.mexmaci64', 'algorithms/models/ExpSmooth','f');
+            movefile('DREAM_generation.mexmaci64', 'algorithms/calibration/DREAM','f');
+            movefile('timeSeriesStore.mexmaci64', 'algorithms/utilities','f');
+            movefile('doDataQualityScreening.mexmaci64', 'algorithms/outlierDetection','f');
         elseif isunix
             movefile('doIRFconvolution.mexa64', 'algorithms/models/TransferNoise','f');
             movefile('forcingTransform_soilMoisture.mexa64', 'algorithms/models/TransferNoise/ForcingTransformation','f');
             movefile('doExpSmoothing.mexa64', 'algorithms/models/ExpSmooth','f');
+            movefile('DREAM_generation.mexa64', 'algorithms/calibration/DREAM','f');
+            movefile('timeSeriesStore.mexa64', 'algorithms/utilities','f');
+            movefile('doDataQualityScreening.mexa64', 'algorithms/outlierDetection','f');
         end
     end    
 end
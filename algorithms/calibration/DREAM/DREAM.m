@@ -163,6 +163,20 @@ if isempty(Meas_info), Meas_info.Y = []; end
     % Create the initial states of each of the chains (initial population)
     [chain,output,X,fx,CR,pCR,lCR,delta_tot,log_L] = DREAM_initialize(DREAMPar,Par_info,Meas_info,f_handle,chain,output,log_L, varargin{:});
 
+    % Check if the compiled generation kernel can be used. It supports
+    % the likelihood being the model output, no prior and no ABC. TJP 2026
+    useNativeGeneration = exist('DREAM_generation','file')==3 && strcmp(DREAMPar.ABC,'no') && ...
+        any(DREAMPar.lik==[1 2]) && ~isfield(Par_info,'prior_marginal');
+    useNativeGelman = exist('DREAM_generation','file')==3;
+    gelmanState = [];
+    if useNativeGeneration
+        try
+            rngState = DREAM_generation('seed', DREAMPar.iseed, DREAMPar.N);
+        catch
+            useNativeGeneration = false;
+        end
+    end
+
 % elseif strcmp(DREAMPar.restart,'yes')
 %     % Print to screen restart run
 %     disp('Restart run');
@@ -183,29 +197,54 @@ totaccept = 0; tic;
 % Now start iteration ...
 for t = T_start : DREAMPar.T
     
-    % Unoack current state of chain and associated log-likelihood and log-prior values
-    [xold,log_PR_xold,log_L_xold] = deal(X(:,1:end-2),X(:,end-1),X(:,end));
-    
-    % Now generate candidate in each sequence using current point and members of X
-    [xnew,CR(:,gen)] = Calc_proposal(xold,CR(:,gen),DREAMPar,Table_gamma,Par_info);
+    % Undertake the proposal, model evaluation, Metropolis step and
+    % crossover update for all chains within one call of the compiled
+    % kernel. If it fails then the MATLAB implementation is used. TJP 2026
+    if useNativeGeneration
+        try
+            [X, fx, CR(:,gen), delta_tot, accept, rngState, xnew, fx_new] = DREAM_generation(X, fx, CR(:,gen), delta_tot, ...
+                Table_gamma, DREAMPar, Par_info, rngState, f_handle, func_name_validParams, varargin{:});
+            xnew = xnew';
+        catch
+            useNativeGeneration = false;
+        end
+    end
     
-    % Check if the parameters are valid - TJP
-    isValid = all(feval(func_name_validParams,xnew', varargin{:}),1)';
-    fx_new = -inf(1,size(xnew,1));
+    if ~useNativeGeneration
+        % Unoack current state of chain and associated log-likelihood and log-prior values
+        [xold,log_PR_xold,log_L_xold] = deal(X(:,1:end-2),X(:,end-1),X(:,end));
 
-    % Now evaluate the model ( = pdf ) and return fx
-    %[fx_new] = Evaluate_model(xnew,DREAMPar,Meas_info,f_handle, varargin{:});
-    fx_new(isValid) = f_handle(xnew(isValid,:)', varargin{:});   % For for calling HydroSight model - TJP
-    
-    % Calculate the log-likelihood and log-prior of x (fx)
-    [log_L_xnew,log_PR_xnew] = Calc_density(xnew,fx_new,DREAMPar,Par_info,Meas_info);
-    
-    % Calculate the Metropolis ratio
-    [accept,idx_ac] = Metropolis_rule(DREAMPar,log_L_xnew,log_PR_xnew,log_L_xold,log_PR_xold);
-    
-    % And update X and the model simulation
-    X(idx_ac,1:DREAMPar.d+2) = [xnew(idx_ac,1:DREAMPar.d) log_PR_xnew(idx_ac,1) log_L_xnew(idx_ac,1)]; 
-    fx(:,idx_ac) = fx_new(:,idx_ac);
+        % Now generate candidate in each sequence using current point and members of X
+        [xnew,CR(:,gen)] = Calc_proposal(xold,CR(:,gen),DREAMPar,Table_gamma,Par_info);
+
+        % Check if the parameters are valid - TJP
+        isValid = all(feval(func_name_validParams,xnew', varargin{:}),1)';
+        fx_new = -inf(1,size(xnew,1));
+
+        % Now evaluate the model ( = pdf ) and return fx
+        %[fx_new] = Evaluate_model(xnew,DREAMPar,Meas_info,f_handle, varargin{:});
+        fx_new(isValid) = f_handle(xnew(isValid,:)', varargin{:});   % For for calling HydroSight model - TJP
+
+        % Calculate the log-likelihood and log-prior of x (fx)
+        [log_L_xnew,log_PR_xnew] = Calc_density(xnew,fx_new,DREAMPar,Par_info,Meas_info);
+
+        % Calculate the Metropolis ratio
+        [accept,idx_ac] = Metropolis_rule(DREAMPar,log_L_xnew,log_PR_xnew,log_L_xold,log_PR_xold);
+
+        % And update X and the model simulation
+        X(idx_ac,1:DREAMPar.d+2) = [xnew(idx_ac,1:DREAMPar.d) log_PR_xnew(idx_ac,1) log_L_xnew(idx_ac,1)]; 
+        fx(:,idx_ac) = fx_new(:,idx_ac);
+
+        % Check whether we update the crossover values
+        if strcmp(DREAMPar.adapt_pCR,'yes')
+            % Calculate the standard deviation of each dimension of X
+            r = repmat(std(X(1:DREAMPar.N,1:DREAMPar.d)),DREAMPar.N,1);
+            % Compute the Euclidean distance between new X and old X
+            delta_normX = sum(((xold(1:end,1:DREAMPar.d) - X(1:end,1:DREAMPar.d))./r).^2,2);
+            % Use this information to update sum_p2 to update N_CR
+            delta_tot = Calc_delta(DREAMPar,delta_tot,delta_normX,CR(1:DREAMPar.N,gen));
+        end
+    end
     
     % Check whether to add the current points to the chains or not?
     if mod(t,DREAMPar.thinning) == 0
@@ -215,16 +254,6 @@ for t = T_start : DREAMPar.T
         % Store the model simulations (if appropriate)
         DREAM_store_results ( DREAMPar , fx , Meas_info , 'a+' );
     end
-    
-    % Check whether we update the crossover values
-    if strcmp(DREAMPar.adapt_pCR,'yes')
-        % Calculate the standard deviation of each dimension of X
-        r = repmat(std(X(1:DREAMPar.N,1:DREAMPar.d)),DREAMPar.N,1);
-        % Compute the Euclidean distance between new X and old X
-        delta_normX = sum(((xold(1:end,1:DREAMPar.d) - X(1:end,1:DREAMPar.d))./r).^2,2);
-        % Use this information to update sum_p2 to update N_CR
-        delta_tot = Calc_delta(DREAMPar,delta_tot,delta_normX,CR(1:DREAMPar.N,gen));
-    end
     % Update gen
     gen = gen + 1;
     
@@ -260,8 +289,20 @@ for t = T_start : DREAMPar.T
         % Calculate Gelman and Rubin Convergence Diagnostic
         start_idx = max(1,floor(iloc/2)); end_idx = iloc;
         
-        % Compute the R-statistic using 50% burn-in from chain
-        [output.R_stat(iteration,1:DREAMPar.d+1)] = [ t * DREAMPar.N Gelman(chain(start_idx:end_idx,1:DREAMPar.d,1:DREAMPar.N),DREAMPar)];        
+        % Compute the R-statistic using 50% burn-in from chain. The
+        % compiled kernel only visits the samples added to or removed from
+        % the window since the last call. TJP 2026
+        if useNativeGelman
+            try
+                [R_stat, gelmanState] = DREAM_generation('gelman', chain, iloc, gelmanState);
+            catch
+                useNativeGelman = false;
+            end
+        end
+        if ~useNativeGelman
+            R_stat = Gelman(chain(start_idx:end_idx,1:DREAMPar.d,1:DREAMPar.N),DREAMPar);
+        end
+        [output.R_stat(iteration,1:DREAMPar.d+1)] = [ t * DREAMPar.N R_stat];        
         
         % Save the output or not?
         if strcmpi(DREAMPar.save,'yes')
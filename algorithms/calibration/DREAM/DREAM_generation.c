@@ -0,0 +1,614 @@
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "mex.h"
+#include "../../kernelStats.h"
+
+/* DREAM_generation undertakes one DREAM generation for all chains in a single native call.
+ *
+ * Syntax:
+ *   rngState = DREAM_generation('seed', iseed, N)
+ *   [X, fx, CR, delta_tot, accept, rngState, xnew, fx_new] = DREAM_generation(X, fx, CR, delta_tot, Table_gamma, ...
+ *       DREAMPar, Par_info, rngState, f_handle, func_name_validParams, varargin)
+ *   [R_stat, gelmanState] = DREAM_generation('gelman', chain, iloc, gelmanState)
+ *   stats = DREAM_generation('stats')
+ *   DREAM_generation('stats_reset')
+ *   DREAM_generation('stats_enable', flag)
+ *
+ * Description:
+ *   The generation step replicates Calc_proposal.m, Boundary_handling.m,
+ *   Calc_density.m (for DREAMPar.lik = 1 or 2 and no prior), Metropolis_rule.m
+ *   (for DREAMPar.ABC = 'no') and Calc_delta.m. The current chain states are
+ *   held in chain-major buffers (ie the parameters of each chain are contiguous)
+ *   and so the proposals for all chains are passed to the parameter validity
+ *   function and then the objective function within one call each.
+ *
+ *   Random numbers are drawn from an independent xoshiro256** stream per chain.
+ *   The streams are seeded from DREAMPar.iseed by the 'seed' command and their
+ *   state is returned after each generation. The results are therefore
+ *   reproducible for a given seed and indifferent of the number of threads,
+ *   but differ from those of the MATLAB implementation.
+ *
+ *   The 'gelman' command derives the Gelman-Rubin R-statistic (as per Gelman.m)
+ *   for the last 50% of the chain. The sum and sum of squares of each chain
+ *   within this window are stored within gelmanState and only the samples
+ *   added to or dropped from the window since the prior call are visited.
+ *
+ *   The 'stats' commands return, reset and enable the run time statistics of
+ *   the generation step (see kernelStats.h). The points are the number of 
+ *   chains. Because the wall time includes the calls to the parameter 
+ *   validity and objective functions, the time within these calls and the 
+ *   number of objective function evaluations are also returned.
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#define BOUNDS_NONE 0
+#define BOUNDS_REFLECT 1
+#define BOUNDS_BOUND 2
+#define BOUNDS_FOLD 3
+
+#define GELMAN_MIN_SAMPLES 10
+
+static const char *gelmanFieldNames[] = {"first", "last", "shift", "S1", "S2"};
+static const char *statsFieldNames[] = {"callbackTime", "objectiveEvaluations"};
+
+static kernelStats stats = {0, 0.0, 0.0, 0.0, 0.0};
+static double statsCallbackTime = 0.0, statsObjectiveEvaluations = 0.0;
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* Declare functions */
+    void seedStreams(unsigned long long seed, int N, unsigned long long *state);
+    void generation(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+    void gelman(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+    char command[16];
+    int N;
+    double iseed;
+
+    if (nrhs>0 && mxIsChar(prhs[0])) {
+        mxGetString(prhs[0], command, sizeof(command));
+        if (strcmp(command, "seed")==0 && nrhs==3) {
+            /* Create one random number stream per chain from the seed. */
+            iseed = fabs(mxGetScalar(prhs[1]));
+            N = (int) mxGetScalar(prhs[2]);
+            plhs[0] = mxCreateNumericMatrix(4, N, mxUINT64_CLASS, mxREAL);
+            seedStreams((unsigned long long) floor(iseed), N, (unsigned long long *) mxGetData(plhs[0]));
+        } else if (strcmp(command, "gelman")==0 && nrhs==4) {
+            gelman(nlhs, plhs, nrhs, prhs);
+        } else if (strcmp(command, "stats")==0) {
+            plhs[0] = kernelStats_toStruct(&stats, 2, statsFieldNames);
+            mxSetField(plhs[0], 0, "callbackTime", mxCreateDoubleScalar(statsCallbackTime));
+            mxSetField(plhs[0], 0, "objectiveEvaluations", mxCreateDoubleScalar(statsObjectiveEvaluations));
+        } else if (strcmp(command, "stats_reset")==0) {
+            kernelStats_reset(&stats);
+            statsCallbackTime = 0.0;
+            statsObjectiveEvaluations = 0.0;
+        } else if (strcmp(command, "stats_enable")==0) {
+            kernelStats_enable(&stats, nrhs, prhs);
+        } else {
+            mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "Unknown command or incorrect number of inputs.");
+        }
+        return;
+    }
+
+    if (nrhs<10)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "At least 10 inputs are required.");
+
+    generation(nlhs, plhs, nrhs, prhs);
+}
+
+/* xoshiro256** generator, see http://prng.di.unimi.it/ */
+static unsigned long long rotl(const unsigned long long x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static unsigned long long nextRandom(unsigned long long *s)
+{
+    const unsigned long long result = rotl(s[1] * 5, 7) * 9;
+    const unsigned long long t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+/* Uniform random number in [0,1). */
+static double rand_uniform(unsigned long long *s)
+{
+    return (double) (nextRandom(s) >> 11) * (1.0/9007199254740992.0);
+}
+
+/* Standard normal random number using the Box-Muller transform. */
+static double rand_normal(unsigned long long *s)
+{
+    const double u1 = 1.0 - rand_uniform(s);
+    const double u2 = rand_uniform(s);
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+/* Random integer in [0,n). */
+static int rand_integer(unsigned long long *s, int n)
+{
+    int k = (int) (rand_uniform(s) * n);
+    return k < n ? k : n - 1;
+}
+
+void seedStreams(unsigned long long seed, int N, unsigned long long *state)
+{
+    /* Use splitmix64 to expand the seed into the state of each stream. */
+    int i;
+    unsigned long long z;
+    for (i=0; i<4*N; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state[i] = z ^ (z >> 31);
+    }
+}
+
+static int getBoundHandling(const mxArray *Par_info)
+{
+    char str[16];
+    const mxArray *field = mxGetField(Par_info, 0, "boundhandling");
+    if (field==NULL || !mxIsChar(field))
+        return BOUNDS_NONE;
+    mxGetString(field, str, sizeof(str));
+    if (strcmp(str, "reflect")==0)
+        return BOUNDS_REFLECT;
+    else if (strcmp(str, "bound")==0)
+        return BOUNDS_BOUND;
+    else if (strcmp(str, "fold")==0)
+        return BOUNDS_FOLD;
+    return BOUNDS_NONE;
+}
+
+static double getScalarField(const mxArray *s, const char *name)
+{
+    const mxArray *field = mxGetField(s, 0, name);
+    if (field==NULL)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "DREAMPar.%s is required.", name);
+    return mxGetScalar(field);
+}
+
+static int isFieldYes(const mxArray *s, const char *name)
+{
+    char str[8];
+    const mxArray *field = mxGetField(s, 0, name);
+    if (field==NULL || !mxIsChar(field))
+        return 0;
+    mxGetString(field, str, sizeof(str));
+    return strcmp(str, "yes")==0;
+}
+
+void generation(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* Declare functions */
+    void proposal(const double *xold, double *xnew, double *CR, const double *Table_gamma, int N, int d,
+            int nPairs, double zeta, double lambda, double p_unit_gamma, unsigned long long *rngState);
+    void boundaryHandling(double *xnew, const double *par_min, const double *par_max, int N, int d,
+            int boundHandling, unsigned long long *rngState);
+
+    /* Declare inputs. X is N x (d+2) as per DREAM.m. */
+    const mxArray *DREAMPar = prhs[5], *Par_info = prhs[6];
+    const int N = (int) mxGetM(prhs[0]);
+    const int nColsX = (int) mxGetN(prhs[0]);
+    const int d = nColsX - 2;
+    const double *X_in = mxGetPr(prhs[0]);
+    const double *Table_gamma = mxGetPr(prhs[4]);
+    const int nCR = (int) getScalarField(DREAMPar, "nCR");
+    const int nPairs = (int) getScalarField(DREAMPar, "delta");
+    const int lik = (int) getScalarField(DREAMPar, "lik");
+    const double zeta = getScalarField(DREAMPar, "zeta");
+    const double lambda = getScalarField(DREAMPar, "lambda");
+    const double p_unit_gamma = getScalarField(DREAMPar, "p_unit_gamma");
+    const int adapt_pCR = isFieldYes(DREAMPar, "adapt_pCR");
+    const int boundHandling = getBoundHandling(Par_info);
+    const mxArray *par_min_mx = mxGetField(Par_info, 0, "min"), *par_max_mx = mxGetField(Par_info, 0, "max");
+
+    /* Declare working variables */
+    mxArray *rhs_valid[64], *rhs_obj[64], *lhs[1], *xValid_mx;
+    double *X, *fx, *CR, *delta_tot, *accept, *xold, *xnew, *fx_new, *xValid, *log_L_xnew, *r, *rnd_accept;
+    const double *valid, *fx_valid, *par_min, *par_max;
+    unsigned long long *rngState;
+    mxLogical *validLogical;
+    int i, j, k, nValid, nVarargin, nRowsValid, isValid, isLogical;
+    double alfa, delta_normX, meanX, ss, tStart = 0.0, tCallback = 0.0;
+
+    if (nrhs - 10 > 62)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "Too many additional objective function inputs.");
+    if (N<3)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "At least 3 chains are required.");
+    if (d<1 || mxGetNumberOfElements(prhs[1])!=(size_t)N || mxGetNumberOfElements(prhs[2])!=(size_t)N
+    || mxGetNumberOfElements(prhs[7])!=(size_t)(4*N) || mxGetClassID(prhs[7])!=mxUINT64_CLASS)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "The size of X, fx, CR or rngState is inconsistent with the number of chains.");
+    if (lik!=1 && lik!=2)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:unsupported", "Only DREAMPar.lik = 1 or 2 is supported.");
+    if (par_min_mx==NULL || par_max_mx==NULL || mxGetNumberOfElements(par_min_mx)!=(size_t)d || mxGetNumberOfElements(par_max_mx)!=(size_t)d)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "Par_info.min and Par_info.max must have one value per parameter.");
+    par_min = mxGetPr(par_min_mx);
+    par_max = mxGetPr(par_max_mx);
+
+    if (stats.enabled)
+        tStart = kernelStats_clock();
+
+    /* Create outputs from the inputs */
+    plhs[0] = mxDuplicateArray(prhs[0]);
+    X = mxGetPr(plhs[0]);
+    plhs[1] = mxDuplicateArray(prhs[1]);
+    fx = mxGetPr(plhs[1]);
+    plhs[2] = mxDuplicateArray(prhs[2]);
+    CR = mxGetPr(plhs[2]);
+    plhs[3] = mxDuplicateArray(prhs[3]);
+    delta_tot = mxGetPr(plhs[3]);
+    plhs[4] = mxCreateDoubleMatrix(N, 1, mxREAL);
+    accept = mxGetPr(plhs[4]);
+    plhs[5] = mxDuplicateArray(prhs[7]);
+    rngState = (unsigned long long *) mxGetData(plhs[5]);
+    plhs[6] = mxCreateDoubleMatrix(d, N, mxREAL);
+    xnew = mxGetPr(plhs[6]);
+    plhs[7] = mxCreateDoubleMatrix(1, N, mxREAL);
+    fx_new = mxGetPr(plhs[7]);
+
+    /* Transpose the current states into a chain-major buffer. */
+    xold = (double *) mxMalloc(d*N*sizeof(double));
+    for (j=0; j<d; j++)
+        for (i=0; i<N; i++)
+            xold[i*d + j] = X_in[j*N + i];
+
+    /* Generate the proposals and undertake boundary handling. */
+    proposal(xold, xnew, CR, Table_gamma, N, d, nPairs, zeta, lambda, p_unit_gamma, rngState);
+    boundaryHandling(xnew, par_min, par_max, N, d, boundHandling, rngState);
+
+    /* Check which proposals are valid. The proposals are already d x N and
+     * so are passed to the function without a copy. */
+    nVarargin = nrhs - 10;
+    rhs_valid[0] = (mxArray *) prhs[9];
+    rhs_valid[1] = plhs[6];
+    for (k=0; k<nVarargin; k++)
+        rhs_valid[k+2] = (mxArray *) prhs[k+10];
+    if (stats.enabled)
+        tCallback = kernelStats_clock();
+    mexCallMATLAB(1, lhs, nVarargin + 2, rhs_valid, "feval");
+    if (stats.enabled)
+        statsCallbackTime += kernelStats_clock() - tCallback;
+
+    if (mxGetN(lhs[0])!=(size_t)N)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidOutput", "The parameter validity function must return one column per chain.");
+    nRowsValid = (int) mxGetM(lhs[0]);
+    isLogical = mxIsLogical(lhs[0]);
+    validLogical = isLogical ? mxGetLogicals(lhs[0]) : NULL;
+    valid = isLogical ? NULL : mxGetPr(lhs[0]);
+
+    /* Gather the valid proposals. Invalid proposals are given an objective of -inf. */
+    xValid_mx = mxCreateDoubleMatrix(d, N, mxREAL);
+    xValid = mxGetPr(xValid_mx);
+    nValid = 0;
+    for (i=0; i<N; i++) {
+        isValid = 1;
+        for (j=0; j<nRowsValid; j++) {
+            if ((isLogical && !validLogical[i*nRowsValid + j]) || (!isLogical && valid[i*nRowsValid + j]==0.0)) {
+                isValid = 0;
+                break;
+            }
+        }
+        accept[i] = isValid;
+        fx_new[i] = -mxGetInf();
+        if (isValid) {
+            memcpy(xValid + nValid*d, xnew + i*d, d*sizeof(double));
+            nValid++;
+        }
+    }
+    mxDestroyArray(lhs[0]);
+
+    /* Evaluate the objective function for all valid proposals in one call. */
+    if (nValid>0) {
+        mxSetN(xValid_mx, nValid);
+        rhs_obj[0] = (mxArray *) prhs[8];
+        rhs_obj[1] = xValid_mx;
+        for (k=0; k<nVarargin; k++)
+            rhs_obj[k+2] = (mxArray *) prhs[k+10];
+        if (stats.enabled)
+            tCallback = kernelStats_clock();
+        mexCallMATLAB(1, lhs, nVarargin + 2, rhs_obj, "feval");
+        if (stats.enabled) {
+            statsCallbackTime += kernelStats_clock() - tCallback;
+            statsObjectiveEvaluations += nValid;
+        }
+
+        if (mxGetNumberOfElements(lhs[0])!=(size_t)nValid || !mxIsDouble(lhs[0]))
+            mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidOutput", "The objective function must return one value per parameter set.");
+        fx_valid = mxGetPr(lhs[0]);
+        k = 0;
+        for (i=0; i<N; i++) {
+            if (accept[i]!=0.0) {
+                fx_new[i] = fx_valid[k];
+                k++;
+            }
+        }
+        mxDestroyArray(lhs[0]);
+    }
+    mxDestroyArray(xValid_mx);
+
+    /* Calculate the log-likelihood of the proposals and apply the Metropolis
+     * rule. The log-prior is zero for both the old and new states and so is
+     * omitted from the ratio. */
+    log_L_xnew = (double *) mxMalloc(N*sizeof(double));
+    rnd_accept = (double *) mxMalloc(N*sizeof(double));
+    for (i=0; i<N; i++) {
+        if (lik==1)
+            log_L_xnew[i] = fx_new[i]>0.0 ? log(fx_new[i]) : -mxGetInf();
+        else
+            log_L_xnew[i] = fx_new[i];
+        rnd_accept[i] = rand_uniform(rngState + 4*i);
+
+        alfa = exp(log_L_xnew[i] - X_in[(d+1)*N + i]) * exp(0.0 - X_in[d*N + i]);
+        accept[i] = alfa > rnd_accept[i];
+
+        if (accept[i]!=0.0) {
+            for (j=0; j<d; j++)
+                X[j*N + i] = xnew[i*d + j];
+            X[d*N + i] = 0.0;
+            X[(d+1)*N + i] = log_L_xnew[i];
+            fx[i] = fx_new[i];
+        }
+    }
+
+    /* Update the total normalised Euclidean jump distance for each crossover value. */
+    if (adapt_pCR) {
+        r = (double *) mxMalloc(d*sizeof(double));
+        for (j=0; j<d; j++) {
+            meanX = 0.0;
+            for (i=0; i<N; i++)
+                meanX += X[j*N + i];
+            meanX /= N;
+            ss = 0.0;
+            for (i=0; i<N; i++)
+                ss += (X[j*N + i] - meanX) * (X[j*N + i] - meanX);
+            r[j] = sqrt(ss/(N-1));
+        }
+        for (i=0; i<N; i++) {
+            delta_normX = 0.0;
+            for (j=0; j<d; j++)
+                delta_normX += pow((xold[i*d + j] - X[j*N + i])/r[j], 2.0);
+            for (k=1; k<=nCR; k++) {
+                if (CR[i]==(double)k/(double)nCR) {
+                    delta_tot[k-1] += delta_normX;
+                    break;
+                }
+            }
+        }
+        mxFree(r);
+    }
+
+    mxFree(rnd_accept);
+    mxFree(log_L_xnew);
+    mxFree(xold);
+
+    /* Bytes of the input and output chain states and the proposals. */
+    if (stats.enabled)
+        kernelStats_record(&stats, tStart, N, sizeof(double) * N * (2.0*(d + 2) + 3.0*d + 4.0));
+}
+
+void proposal(const double *xold, double *xnew, double *CR, const double *Table_gamma, int N, int d,
+        int nPairs, double zeta, double lambda, double p_unit_gamma, unsigned long long *rngState)
+{
+    /* Each chain draws from its own random number stream and so the chains
+     * can be evolved in parallel. */
+    int i;
+    #pragma omp parallel for
+    for (i=0; i<N; i++) {
+        unsigned long long *s = rngState + 4*i;
+        const double *x_i = xold + i*d;
+        double *xnew_i = xnew + i*d;
+        int j, k, tmp, DE_pairs, D, isUnitGamma, others[2048], *draw;
+        double gamma_D, delta;
+
+        /* Determine the number of chain pairs and randomly draw 2*DE_pairs
+         * other chains using a partial Fisher-Yates shuffle. */
+        DE_pairs = 1 + rand_integer(s, nPairs);
+        if (2*DE_pairs > N-1)
+            DE_pairs = (N-1)/2;
+        draw = N-1 <= 2048 ? others : (int *) malloc((N-1)*sizeof(int));
+        for (k=0; k<N-1; k++)
+            draw[k] = k < i ? k : k+1;
+        for (k=0; k<2*DE_pairs; k++) {
+            j = k + rand_integer(s, N-1-k);
+            tmp = draw[k];
+            draw[k] = draw[j];
+            draw[j] = tmp;
+        }
+
+        /* Determine when the jump rate is 1 */
+        isUnitGamma = rand_uniform(s) < p_unit_gamma;
+
+        /* Derive the subset of dimensions to sample and the ergodicity
+         * perturbation. The jump is stored in xnew_i until it is added to x_i. */
+        D = 0;
+        for (j=0; j<d; j++) {
+            xnew_i[j] = rand_uniform(s) < CR[i] ? 1.0 : 0.0;
+            D += (int) xnew_i[j];
+        }
+
+        /* Make sure that at least one dimension is selected! */
+        if (D==0) {
+            xnew_i[rand_integer(s, d)] = 1.0;
+            D = 1;
+        }
+
+        if (isUnitGamma) {
+            gamma_D = 1.0;
+            /* Set CR to -1 so that this jump does not count for calculation of pCR */
+            CR[i] = -1.0;
+        } else {
+            gamma_D = Table_gamma[(D-1) + (DE_pairs-1)*d];
+        }
+
+        for (j=0; j<d; j++) {
+            if (!isUnitGamma && xnew_i[j]==0.0) {
+                xnew_i[j] = x_i[j];
+                continue;
+            }
+            delta = 0.0;
+            for (k=0; k<DE_pairs; k++)
+                delta += xold[draw[k]*d + j] - xold[draw[k+DE_pairs]*d + j];
+            xnew_i[j] = x_i[j] + (1.0 + lambda*(2.0*rand_uniform(s) - 1.0)) * gamma_D * delta + zeta*rand_normal(s);
+        }
+
+        if (draw!=others)
+            free(draw);
+    }
+}
+
+void boundaryHandling(double *xnew, const double *par_min, const double *par_max, int N, int d,
+        int boundHandling, unsigned long long *rngState)
+{
+    int i, j;
+    double x;
+
+    if (boundHandling==BOUNDS_NONE)
+        return;
+
+    for (i=0; i<N; i++) {
+        for (j=0; j<d; j++) {
+            x = xnew[i*d + j];
+            if (x < par_min[j]) {
+                if (boundHandling==BOUNDS_REFLECT)
+                    x = 2.0*par_min[j] - x;
+                else if (boundHandling==BOUNDS_BOUND)
+                    x = par_min[j];
+                else
+                    x = par_max[j] - (par_min[j] - x);
+            } else if (x > par_max[j]) {
+                if (boundHandling==BOUNDS_REFLECT)
+                    x = 2.0*par_max[j] - x;
+                else if (boundHandling==BOUNDS_BOUND)
+                    x = par_max[j];
+                else
+                    x = par_min[j] + (x - par_max[j]);
+            }
+
+            /* Resample elements that are still out of bounds, which is
+             * possible if the jump is larger than the parameter range. */
+            if (x < par_min[j] || x > par_max[j])
+                x = par_min[j] + rand_uniform(rngState + 4*i) * (par_max[j] - par_min[j]);
+            xnew[i*d + j] = x;
+        }
+    }
+}
+
+void gelman(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* Declare inputs. chain is nRows x (d+2) x N as per DREAM.m. */
+    const mxArray *chain_mx = prhs[1];
+    const mwSize *dims = mxGetDimensions(chain_mx);
+    const int nRows = (int) dims[0];
+    const int d = (int) dims[1] - 2;
+    const int N = mxGetNumberOfDimensions(chain_mx) > 2 ? (int) dims[2] : 1;
+    const int iloc = (int) mxGetScalar(prhs[2]);
+    const int first = iloc/2 > 1 ? iloc/2 : 1;
+    const double *chain = mxGetPr(chain_mx);
+
+    /* Declare working variables */
+    mxArray *state;
+    double *shift, *S1, *S2, *R_stat, *mean_chain, x, n, W, B, mean_all, sigma2, var_chain;
+    int i, j, k, prevFirst = 0, prevLast = 0, doReset;
+
+    if (d<1 || iloc<1 || iloc>nRows)
+        mexErrMsgIdAndTxt("HydroSight:DREAM_generation:invalidInput", "The chain must be nRows x (d+2) x N and iloc within 1 to nRows.");
+
+    /* Reuse the prior state if it is for the same chain window, else reset it. */
+    doReset = !mxIsStruct(prhs[3]) || mxGetField(prhs[3], 0, "S1")==NULL
+            || mxGetNumberOfElements(mxGetField(prhs[3], 0, "S1"))!=(size_t)(d*N);
+    if (!doReset) {
+        prevFirst = (int) mxGetScalar(mxGetField(prhs[3], 0, "first"));
+        prevLast = (int) mxGetScalar(mxGetField(prhs[3], 0, "last"));
+        doReset = first < prevFirst || iloc < prevLast || prevLast < first;
+    }
+    if (doReset) {
+        state = mxCreateStructMatrix(1, 1, 5, gelmanFieldNames);
+        mxSetField(state, 0, "shift", mxCreateDoubleMatrix(d, N, mxREAL));
+        mxSetField(state, 0, "S1", mxCreateDoubleMatrix(d, N, mxREAL));
+        mxSetField(state, 0, "S2", mxCreateDoubleMatrix(d, N, mxREAL));
+        shift = mxGetPr(mxGetField(state, 0, "shift"));
+        for (k=0; k<N; k++)
+            for (j=0; j<d; j++)
+                shift[k*d + j] = chain[(first-1) + j*nRows + k*nRows*(d+2)];
+        prevFirst = first;
+        prevLast = first - 1;
+    } else {
+        state = mxDuplicateArray(prhs[3]);
+        shift = mxGetPr(mxGetField(state, 0, "shift"));
+    }
+    S1 = mxGetPr(mxGetField(state, 0, "S1"));
+    S2 = mxGetPr(mxGetField(state, 0, "S2"));
+
+    /* Add the new samples and remove those that have left the window. The
+     * samples are shifted to reduce the round-off error of the sum of squares. */
+    for (k=0; k<N; k++) {
+        for (j=0; j<d; j++) {
+            for (i=prevLast; i<iloc; i++) {
+                x = chain[i + j*nRows + k*nRows*(d+2)] - shift[k*d + j];
+                S1[k*d + j] += x;
+                S2[k*d + j] += x*x;
+            }
+            for (i=prevFirst-1; i<first-1; i++) {
+                x = chain[i + j*nRows + k*nRows*(d+2)] - shift[k*d + j];
+                S1[k*d + j] -= x;
+                S2[k*d + j] -= x*x;
+            }
+        }
+    }
+    mxSetField(state, 0, "first", mxCreateDoubleScalar(first));
+    mxSetField(state, 0, "last", mxCreateDoubleScalar(iloc));
+
+    /* Calculate the R-statistic */
+    plhs[0] = mxCreateDoubleMatrix(1, d, mxREAL);
+    R_stat = mxGetPr(plhs[0]);
+    n = iloc - first + 1;
+    if (n < GELMAN_MIN_SAMPLES) {
+        for (j=0; j<d; j++)
+            R_stat[j] = mxGetNaN();
+    } else {
+        mean_chain = (double *) mxMalloc(N*sizeof(double));
+        for (j=0; j<d; j++) {
+            W = 0.0;
+            mean_all = 0.0;
+            for (k=0; k<N; k++) {
+                mean_chain[k] = S1[k*d + j]/n;
+                var_chain = (S2[k*d + j] - S1[k*d + j]*mean_chain[k])/(n - 1.0);
+                W += var_chain > 0.0 ? var_chain : 0.0;
+                mean_chain[k] += shift[k*d + j];
+                mean_all += mean_chain[k];
+            }
+            W /= N;
+            mean_all /= N;
+            B = 0.0;
+            for (k=0; k<N; k++)
+                B += (mean_chain[k] - mean_all) * (mean_chain[k] - mean_all);
+            B = n * B/(N - 1.0);
+
+            sigma2 = ((n - 1.0)/n) * W + (1.0/n) * B;
+            R_stat[j] = sqrt((N + 1.0)/N * sigma2/W - (n - 1.0)/N/n);
+        }
+        mxFree(mean_chain);
+    }
+
+    if (nlhs>1)
+        plhs[1] = state;
+    else
+        mxDestroyArray(state);
+}
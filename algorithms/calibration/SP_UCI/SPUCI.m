@@ -138,6 +138,7 @@ bestx_ever=bestx;
 nloop=0;
 nloop_prior = 0;
 minloops = 2*kstop;
+complexRunTime = zeros(ngs,1);
 %isbestf_ever_inkstop = false;
 while nloop<=minloops || (icall<maxn && gnrng>peps && criter_change>pcento)
     nloop=nloop+1;
@@ -179,37 +180,19 @@ while nloop<=minloops || (icall<maxn && gnrng>peps && criter_change>pcento)
         
     end
     
-    % Initialise cell array for cx and cf
-    cx = cell(ngs,1);
-    cf = cell(ngs,1);
-    cicall = zeros(ngs,1);
+    % Initialise cell array for the derived forcing of each complex
     if nloop==1
      stochDerivedForcingData = cell(ngs,1);
     end
-    model = varargin{1};
         
-    % Loop on complexes (sub-populations);
+    % Loop on complexes (sub-populations). Each complex is evolved as an 
+    % independent task on the parallel pool, with the slowest complexes 
+    % from the prior loop submitted first, and the results collected as 
+    % each finishes. Tim Peterson 2026
     %disp('DBG: Starting updating of complexes');
-    parfor igs = 1: ngs
-
-        % Initialise random number generator to a known seed based on the
-        % input seed and the iterations
-        if ~isempty(iseed) && isnumeric(iseed)
-            rng(iseed + nloop + igs);
-        end
-
-        % Assign derived forcing using xigs
-        if useDerivedForcing && nloop>1
-            updateStochForcingData(model, stochDerivedForcingData{igs});
-        end
-        
-        % This is the major computionation load. It was shifted into a
-        % stand alone function by Tim Peterson to allow parrellisation.
-        [cx{igs}, cf{igs}, cicall(igs), stochDerivedForcingData{igs}] = doComplexEvolution(funcHandle, funcHangle_validParams, ind{igs}, x, xf, ...
-        bl_phys,bu_phys, nspl, nps, npg, useDerivedForcing , igs, varargin{:});
-        
-    % End of Loop on Complex Evolution;
-    end
+    [cx, cf, cicall, stochDerivedForcingData, complexRunTime] = evolveComplexes(funcHandle, funcHangle_validParams, ind, x, xf, ...
+        bl_phys,bu_phys, nspl, nps, npg, useDerivedForcing, stochDerivedForcingData, useDerivedForcing && nloop>1, ...
+        (nloop_prior + nloop - 1)*ngs, iseed, complexRunTime, varargin{:});
     %disp('DBG: Finished updating of complexes');    
 
     % Check if derived forcing is to be handled
@@ -497,6 +480,100 @@ end
 
 end
 
+function [cx, cf, cicall, forcingData, runTime] = evolveComplexes(funcHandle, funcHangle_validParams, ind, x, xf, bl, bu, nspl, nps, npg, ...
+    useDerivedForcing, forcingData, assignDerivedForcing, substreamOffset, iseed, runTime, varargin)
+        
+        % Evolves all complexes for one loop. If a parallel pool is open
+        % (or is started by gcp()) then each complex is submitted to the
+        % pool using parfeval(). 
+        % The pool hands each task to the next idle worker and so, by 
+        % submitting the complexes with the largest run time in the prior
+        % loop first, the slow complexes do not start last and the workers
+        % are not left idle waiting for them. The results are returned by 
+        % complex number, not in the order they finished, and each complex
+        % uses its own random number substream. Hence, the results for a 
+        % given seed do not depend upon the number of workers or the order
+        % the tasks finish. Tim Peterson 2026
+        
+        ngs = length(ind);
+        cx = cell(ngs,1);
+        cf = cell(ngs,1);
+        cicall = zeros(ngs,1);
+        
+        % Get the parallel pool. As per the prior parfor loop, a pool is
+        % started if none is open and the parallel preferences allow a
+        % pool to be created automatically.
+        try
+            pool = gcp();
+        catch
+            pool = [];
+        end
+        
+        % Order the complexes from the slowest to fastest in the prior loop.
+        [~, complexOrder] = sort(runTime, 'descend');
+        
+        if isempty(pool)
+            % Evolve each complex in the current MATLAB session. The global
+            % random number stream is restored afterwards.
+            globalStream = RandStream.getGlobalStream;
+            for igs = 1:ngs
+                [cx{igs}, cf{igs}, cicall(igs), forcingData{igs}, runTime(igs)] = evolveComplex(funcHandle, funcHangle_validParams, ind{igs}, x, xf, ...
+                    bl, bu, nspl, nps, npg, useDerivedForcing, forcingData{igs}, assignDerivedForcing, igs, substreamOffset + igs, iseed, varargin{:});
+            end
+            RandStream.setGlobalStream(globalStream);
+        else
+            % Submit each complex to the pool.
+            futures = parallel.FevalFuture.empty(0,1);
+            for i = 1:ngs
+                igs = complexOrder(i);
+                futures(i) = parfeval(pool, @evolveComplex, 5, funcHandle, funcHangle_validParams, ind{igs}, x, xf, ...
+                    bl, bu, nspl, nps, npg, useDerivedForcing, forcingData{igs}, assignDerivedForcing, igs, substreamOffset + igs, iseed, varargin{:});
+            end
+            
+            % Collect the results as each complex finishes.
+            try
+                for i = 1:ngs
+                    [iFuture, cx_i, cf_i, icall_i, forcingData_i, runTime_i] = fetchNext(futures);
+                    igs = complexOrder(iFuture);
+                    cx{igs} = cx_i;
+                    cf{igs} = cf_i;
+                    cicall(igs) = icall_i;
+                    forcingData{igs} = forcingData_i;
+                    runTime(igs) = runTime_i;
+                end
+            catch ME
+                cancel(futures);
+                rethrow(ME);
+            end
+        end
+end
+
+function [cx, cf, icall, forcingData, runTime] = evolveComplex(funcHandle, funcHangle_validParams, ind, x, xf, bl, bu, nspl, nps, npg, ...
+    useDerivedForcing, forcingData, assignDerivedForcing, igs, substream, iseed, varargin)
+
+        runTimeStart = tic;
+        
+        % Initialise random number generator to a substream unique to the 
+        % complex and loop.
+        if ~isempty(iseed) && isnumeric(iseed)
+            stream = RandStream('mrg32k3a', 'Seed', mod(floor(abs(iseed)), 2^32));
+            stream.Substream = substream;
+            RandStream.setGlobalStream(stream);
+        end
+
+        % Assign derived forcing using xigs
+        if assignDerivedForcing
+            updateStochForcingData(varargin{1}, forcingData);
+        end
+        
+        % This is the major computionation load. It was shifted into a
+        % stand alone function by Tim Peterson to allow parrellisation.
+        [cx, cf, icall, forcingData] = doComplexEvolution(funcHandle, funcHangle_validParams, ind, x, xf, ...
+            bl, bu, nspl, nps, npg, useDerivedForcing , igs, varargin{:});
+        
+        runTime = toc(runTimeStart);
+end
+
 function [cx, cf, icall, forcingData] = doComplexEvolution(funcHandle, funcHangle_validParams, ind, x, xf, bl, bu, nspl, nps, npg, useDerivedForcing, igs, varargin)
 
         % initialse count of local function calls
@@ -0,0 +1,69 @@
+/* hydroSightKernels.h - the MATLAB independent numerical cores of the MEX kernels.
+ *
+ * The numerical cores within doIRFconvolution.c, forcingTransform_soilMoisture.c,
+ * doExpSmoothing.c and doDataQualityScreening.c have no dependency on MATLAB.
+ * When the files are compiled without MATLAB_MEX_FILE defined (ie not by mex)
+ * the MATLAB gateways are omitted and the files form a plain C library. It is used by the
+ * MEX gateways, the native benchmark (testing/benchmark/benchmarkKernels.c)
+ * and the native batch runner (algorithms/models/TransferNoise/batch/TFN_batch.c).
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifndef HYDROSIGHTKERNELS_H
+#define HYDROSIGHTKERNELS_H
+
+/* Maximum number of Newton-Raphson, and then bisection, iterations per day
+ * of the soil moisture model. */
+#define SOIL_MAX_ITERATIONS 100
+
+/* Convolution of the impulse response function, theta, with the forcing for
+ * one output time point (see doIRFconvolution.c). */
+double trapazoidal(const int theta_index_start, const int theta_index_end, const double *dx, const double *dy,
+        const double *intTheta);
+double Simpsons_ExtendedRule(const int theta_index_start, const int theta_index_end, const double *dx, const double *dy,
+        const double *intTheta);
+
+/* Convolution for all output time points, including the upper tail correction
+ * and, optionally, the sensitivity to the response function parameters (see
+ * doIRFconvolution.c). */
+void convolution_streaming(const double *theta, const double *theta_indexes_start, const int nIndex, const int theta_index_end,
+        const double *forcing, const int isForcingAnIntegral, const double intTheta_0to1, const double *intTheta_upperTail,
+        const double forcingMean, const int tileSize, double *result,
+        const int nTheta, const int nParams, const double *dtheta, const double *dIntTheta_0to1, const double *dIntTheta_upperTail,
+        double *jacobian);
+
+/* Recursive (IIR) convolution for all output time points for theta that is a
+ * sum of terms c * t^m * exp(-a * t) (see doIRFconvolution.c). terms is
+ * nTerms x 3. Returns 0, without a result, if the terms cannot be used. */
+int convolution_recursive(const int nTerms, const double *terms, const double *theta, const int nTheta,
+        const double *theta_indexes_start, const int nIndex, const int theta_index_end,
+        const double *forcing, const int nForcing, const int isForcingAnIntegral, const double intTheta_0to1,
+        const double *intTheta_upperTail, const double forcingMean, double *result);
+
+/* Soil moisture model (see forcingTransform_soilMoisture.c). The histograms
+ * may be NULL. */
+void soilMoistureModel(const unsigned int nDays, const double S0, double *precip, const double *et, const double *temp,
+        const double S_cap, const double Ksat, const double alpha, const double beta, const double gamma, const double eps,
+        const double DDF, const double melt_threshold, double *soilMoisture, unsigned int *nIterations_out,
+        unsigned int *nIterations_bisect_out, double *histogram_newton, double *histogram_bisect);
+
+/* Double exponential smoothing (see doExpSmoothing.c). */
+void expSmoothing(const int nObs, const double *time_points, const double *h_obs, const double *isObsTimePoint,
+        const double h_mean, const double alpha, const double gamma, const double q, const double initialHead,
+        const double initialTrend, double *h_ar, double *h_forecast);
+
+/* Data quality screening of the observed head of one bore (see
+ * doDataQualityScreening.c). settings has SCREENING_N_SETTINGS values and
+ * flags is nObs x SCREENING_N_FLAGS. */
+#define SCREENING_N_SETTINGS 12
+#define SCREENING_N_FLAGS 6
+void dataQualityScreening(const int nObs, const double *time, const double *head, const double *settings,
+        unsigned char *flags);
+
+#endif
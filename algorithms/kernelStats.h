@@ -0,0 +1,100 @@
+/* kernelStats.h - opt-in run time statistics of the MEX kernels.
+ *
+ * Each MEX kernel holds a static kernelStats structure. When enabled (using
+ * the kernel's 'stats_enable' command), each call to the kernel adds to the
+ * number of calls, the number of output points, the wall time and the
+ * (estimated) bytes of input and output touched. The statistics are returned
+ * by the kernel's 'stats' command and zeroed by 'stats_reset'. When not
+ * enabled the only overhead is the check of the enabled flag.
+ *
+ * The statistics of all kernels can be returned, reset, enabled or disabled
+ * from MATLAB using algorithms/utilities/kernelStatistics.m.
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifndef KERNELSTATS_H
+#define KERNELSTATS_H
+
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include "time.h"
+#endif
+
+typedef struct {
+    int enabled;
+    double nCalls;
+    double nPoints;
+    double wallTime;
+    double bytes;
+} kernelStats;
+
+/* Wall clock time (s). */
+static double kernelStats_clock(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1.0e-9 * (double) t.tv_nsec;
+#endif
+}
+
+/* Add one kernel call that started at tStart. */
+static void kernelStats_record(kernelStats *stats, const double tStart, const double nPoints, const double bytes)
+{
+    stats->nCalls += 1.0;
+    stats->nPoints += nPoints;
+    stats->wallTime += kernelStats_clock() - tStart;
+    stats->bytes += bytes;
+}
+
+/* Zero the statistics. The enabled flag is unchanged. */
+static void kernelStats_reset(kernelStats *stats)
+{
+    stats->nCalls = 0.0;
+    stats->nPoints = 0.0;
+    stats->wallTime = 0.0;
+    stats->bytes = 0.0;
+}
+
+#ifdef MATLAB_MEX_FILE
+/* Enable or disable the statistics for the 'stats_enable', flag command. If
+ * the flag is not input then the statistics are enabled. */
+static void kernelStats_enable(kernelStats *stats, int nrhs, const mxArray *prhs[])
+{
+    stats->enabled = nrhs < 2 || mxGetScalar(prhs[1]) != 0.0;
+}
+
+/* Create a 1x1 structure of the statistics. The kernel specific fields are
+ * appended to the common fields and must be set by the kernel. */
+static mxArray *kernelStats_toStruct(const kernelStats *stats, const int nExtraFields, const char **extraFieldNames)
+{
+    const char *fieldNames[16] = {"enabled", "calls", "points", "wallTime", "bytes"};
+    const int nFields = 5;
+    int i;
+    mxArray *s;
+
+    for (i = 0; i < nExtraFields && nFields + i < 16; i++)
+        fieldNames[nFields + i] = extraFieldNames[i];
+    s = mxCreateStructMatrix(1, 1, nFields + i, fieldNames);
+    mxSetField(s, 0, "enabled", mxCreateLogicalScalar(stats->enabled != 0));
+    mxSetField(s, 0, "calls", mxCreateDoubleScalar(stats->nCalls));
+    mxSetField(s, 0, "points", mxCreateDoubleScalar(stats->nPoints));
+    mxSetField(s, 0, "wallTime", mxCreateDoubleScalar(stats->wallTime));
+    mxSetField(s, 0, "bytes", mxCreateDoubleScalar(stats->bytes));
+    return s;
+}
+#endif
+
+#endif
@@ -1,7 +1,29 @@
 #include "math.h"
+#ifdef MATLAB_MEX_FILE
 #include "mex.h"
+#include "string.h"
+#include "../../kernelStats.h"
+#endif
+#include "../../hydroSightKernels.h"
 
+#ifdef MATLAB_MEX_FILE
+/* Run time statistics (see kernelStats.h). */
+static kernelStats stats = {0, 0.0, 0.0, 0.0, 0.0};
+
+void smoothing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+/* Gateway function. If the first input is a string then a statistics command
+ * is undertaken (see statsCommand()). Else, the smoothing is undertaken. */
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
+{
+    if (nrhs > 0 && mxIsChar(prhs[0]))
+        statsCommand(nlhs, plhs, nrhs, prhs);
+    else
+        smoothing(nlhs, plhs, nrhs, prhs);
+}
+
+void smoothing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
 {
     /* Declare number of timesteps */
     const int nObs = mxGetScalar( prhs[0] );
@@ -18,20 +40,64 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             q = mxGetScalar( prhs[7] ),
             initialHead = mxGetScalar( prhs[8] ),
             initialTrend = mxGetScalar( prhs[9] );
-    
-    /* Declare working variables */
-    double alpha_i, gamma_i, gamma_weight, delta_t_prev, h_trend, delta_t;
-    int i, indPrevObs, indPrevObsTimePoint;   
-    const int TRUE = 1.0; 
-    const int FALSE = 0.0; 
 
     /* Create a vectors for results */
-    double *h_ar, *h_forecast;
+    double *h_ar, *h_forecast, tStart = 0.0;
     plhs[0] = mxCreateDoubleMatrix(nObs,1,mxREAL);         
     h_ar = mxGetPr(plhs[0]);
     plhs[1] = mxCreateDoubleMatrix(nObs,1,mxREAL);         
     h_forecast = mxGetPr(plhs[1]);    
     
+    if (stats.enabled)
+        tStart = kernelStats_clock();
+    
+    expSmoothing(nObs, time_points, h_obs, isObsTimePoint, h_mean, alpha, gamma, q, initialHead, initialTrend, 
+            h_ar, h_forecast);
+    
+    /* Bytes of the time points, observed head, observation flags and outputs. */
+    if (stats.enabled)
+        kernelStats_record(&stats, tStart, nObs, 5.0 * sizeof(double) * nObs);
+}
+
+/* Statistics commands. The first input is the command name:
+ *   'stats'
+ *       Returns a structure of the statistics (see kernelStats.h).
+ *   'stats_reset'
+ *       Zeros the statistics.
+ *   'stats_enable', flag
+ *       Enables (default) or disables the statistics.
+ */
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char command[16];
+
+    mxGetString(prhs[0], command, sizeof(command));
+    if (strcmp(command, "stats") == 0)
+        plhs[0] = kernelStats_toStruct(&stats, 0, NULL);
+    else if (strcmp(command, "stats_reset") == 0)
+        kernelStats_reset(&stats);
+    else if (strcmp(command, "stats_enable") == 0)
+        kernelStats_enable(&stats, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("HydroSight:doExpSmoothing:invalidInput",
+                "Unknown command: %s", command);
+}
+#endif
+
+/* Undertakes the double exponential smoothing. It is independent of MATLAB 
+ * so that it can also be called from the native benchmark (see
+ * testing/benchmark/benchmarkKernels.c).
+ */
+void expSmoothing(const int nObs, const double *time_points, const double *h_obs, const double *isObsTimePoint, 
+        const double h_mean, const double alpha, const double gamma, const double q, const double initialHead, 
+        const double initialTrend, double *h_ar, double *h_forecast)
+{
+    /* Declare working variables */
+    double alpha_i, gamma_i, gamma_weight, delta_t_prev, h_trend, delta_t;
+    int i, indPrevObs, indPrevObsTimePoint;   
+    const int TRUE = 1.0; 
+    const int FALSE = 0.0; 
+
   /* DOSMOOTHING Summary of this function goes here */
   /*  Undertake double exponential smoothing. */
   /*  Note: It is based on Cipra T. and Hanzák T. (2008). Exponential */
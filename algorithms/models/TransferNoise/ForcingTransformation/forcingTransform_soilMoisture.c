@@ -1,9 +1,37 @@
 #include "math.h"
+#include "stddef.h"
+#ifdef MATLAB_MEX_FILE
 #include "mex.h"
+#include "string.h"
+#include "../../../kernelStats.h"
+#endif
+#include "../../../hydroSightKernels.h"
 #define MIN(x,y) (x <= y ? x : y)
 #define MAX(x,y) (x <= y ? y : x)
 
+#ifdef MATLAB_MEX_FILE
+/* Run time statistics (see kernelStats.h). In addition to the common
+ * statistics, the histograms of the number of Newton-Raphson and bisection
+ * iterations per day are held. Element i of each histogram is the number of
+ * days requiring i iterations and so the last element is the number of days
+ * that reached the maximum number of iterations. */
+static kernelStats stats = {0, 0.0, 0.0, 0.0, 0.0};
+static double statsHistogram_newton[SOIL_MAX_ITERATIONS+1], statsHistogram_bisect[SOIL_MAX_ITERATIONS+1];
+
+void simulate(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+/* Gateway function. If the first input is a string then a statistics command
+ * is undertaken (see statsCommand()). Else, the soil moisture is simulated. */
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
+{
+    if (nrhs > 0 && mxIsChar(prhs[0]))
+        statsCommand(nlhs, plhs, nrhs, prhs);
+    else
+        simulate(nlhs, plhs, nrhs, prhs);
+}
+
+void simulate(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
 {
     
     /* Declare input model parameters and the number of sub-daily timesteps*/
@@ -20,10 +48,90 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     /* Declare input data */
     double *precip= mxGetPr( prhs[1] );
     const double *et= mxGetPr( prhs[2] ), *temp= mxGetPr( prhs[3] );
+    const unsigned int nDays = (int)mxGetM(prhs[1] );
      
     /* Declare output data */    
     double *soilMoisture;
+    unsigned int nIterations = 0, nIterations_bisect = 0;
+    double tStart;
+    
+    /* Create a vectors for results */
+    plhs[0] = mxCreateDoubleMatrix(nDays,1,mxREAL);         
+    soilMoisture = mxGetPr(plhs[0]);
+
+    if (stats.enabled) {
+        tStart = kernelStats_clock();
+        soilMoistureModel(nDays, S0, precip, et, temp, S_cap, Ksat, alpha, beta, gamma, eps, DDF, melt_threshold, 
+                soilMoisture, &nIterations, &nIterations_bisect, statsHistogram_newton, statsHistogram_bisect);
         
+        /* Bytes of the precip, ET, temperature (if used) and soil moisture. */
+        kernelStats_record(&stats, tStart, nDays, (isfinite(DDF) && isfinite(melt_threshold) ? 4.0 : 3.0) * sizeof(double) * nDays);
+    }
+    else
+        soilMoistureModel(nDays, S0, precip, et, temp, S_cap, Ksat, alpha, beta, gamma, eps, DDF, melt_threshold, 
+                soilMoisture, &nIterations, &nIterations_bisect, NULL, NULL);
+    
+     plhs[1] = mxCreateDoubleScalar(nIterations);
+     plhs[2] = mxCreateDoubleScalar(nIterations_bisect);
+}
+
+/* Statistics commands. The first input is the command name:
+ *   'stats'
+ *       Returns a structure of the common statistics (see kernelStats.h), the 
+ *       iteration histograms and the number of days reaching the maximum 
+ *       number of Newton-Raphson or bisection iterations.
+ *   'stats_reset'
+ *       Zeros the statistics.
+ *   'stats_enable', flag
+ *       Enables (default) or disables the statistics.
+ */
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const char *extraFieldNames[] = {"newtonIterationHistogram", "bisectionIterationHistogram", 
+            "newtonMaxIterationDays", "bisectionMaxIterationDays"};
+    char command[16];
+    mxArray *histogram;
+
+    mxGetString(prhs[0], command, sizeof(command));
+    if (strcmp(command, "stats") == 0) {
+        plhs[0] = kernelStats_toStruct(&stats, 4, extraFieldNames);
+        histogram = mxCreateDoubleMatrix(1, SOIL_MAX_ITERATIONS+1, mxREAL);
+        memcpy(mxGetPr(histogram), statsHistogram_newton, (SOIL_MAX_ITERATIONS+1)*sizeof(double));
+        mxSetField(plhs[0], 0, "newtonIterationHistogram", histogram);
+        histogram = mxCreateDoubleMatrix(1, SOIL_MAX_ITERATIONS+1, mxREAL);
+        memcpy(mxGetPr(histogram), statsHistogram_bisect, (SOIL_MAX_ITERATIONS+1)*sizeof(double));
+        mxSetField(plhs[0], 0, "bisectionIterationHistogram", histogram);
+        mxSetField(plhs[0], 0, "newtonMaxIterationDays", mxCreateDoubleScalar(statsHistogram_newton[SOIL_MAX_ITERATIONS]));
+        mxSetField(plhs[0], 0, "bisectionMaxIterationDays", mxCreateDoubleScalar(statsHistogram_bisect[SOIL_MAX_ITERATIONS]));
+    }
+    else if (strcmp(command, "stats_reset") == 0) {
+        kernelStats_reset(&stats);
+        memset(statsHistogram_newton, 0, (SOIL_MAX_ITERATIONS+1)*sizeof(double));
+        memset(statsHistogram_bisect, 0, (SOIL_MAX_ITERATIONS+1)*sizeof(double));
+    }
+    else if (strcmp(command, "stats_enable") == 0)
+        kernelStats_enable(&stats, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("HydroSight:forcingTransform_soilMoisture:invalidInput",
+                "Unknown command: %s", command);
+}
+#endif
+
+/* Solves the soil moisture model for all days. It is independent of MATLAB 
+ * so that it can also be called from the native benchmark (see
+ * testing/benchmark/benchmarkKernels.c). Note, if snow is simulated then 
+ * precip is updated in place to the rainfall plus melt. The total number of
+ * Newton-Raphson and bisection iterations over all days are returned. If 
+ * histogram_newton and histogram_bisect are not NULL then the number of 
+ * iterations each day is also added to the respective histogram (of length
+ * SOIL_MAX_ITERATIONS+1). Days not requiring bisection are not added to 
+ * histogram_bisect.
+ */
+void soilMoistureModel(const unsigned int nDays, const double S0, double *precip, const double *et, const double *temp,
+        const double S_cap, const double Ksat, const double alpha, const double beta, const double gamma, const double eps, 
+        const double DDF, const double melt_threshold, double *soilMoisture, unsigned int *nIterations_out, 
+        unsigned int *nIterations_bisect_out, double *histogram_newton, double *histogram_bisect)
+{
     /* Declare ODE variables */
     double soilMoisture_frac, 
            dSdt_precip, d2Sdt2_precip, dSdt_et, dSdt_drain,
@@ -32,9 +140,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     /* Declare general ODE solver variables */    
     double f_delta, f, df, relerr, abserr, funcerr;
     const double dt=1.0;
-    const unsigned int nDays = (int)mxGetM(prhs[1] );
     unsigned int iDay, hasSnow;
-    unsigned short its, useNewtonsMethod=1, noPrecip = 1;
+    unsigned short its, its_bisect, useNewtonsMethod=1, noPrecip = 1;
     unsigned int nIterations = 0, nIterations_bisect = 0;
 
     /* Declare bisection solver variables */
@@ -46,12 +153,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     /* Set constants for Newtons solver*/    
     double const absTol = 1.0e-6;
     double const funcTol = 1.0e-6;
-    unsigned short const maxIts = 100;
+    unsigned short const maxIts = SOIL_MAX_ITERATIONS;
     
-    /* Create a vectors for results */
-    plhs[0] = mxCreateDoubleMatrix(nDays,1,mxREAL);         
-    soilMoisture = mxGetPr(plhs[0]);
-
     hasSnow = 0;
     if (isfinite(DDF) && isfinite(melt_threshold)) {
         hasSnow = 1;
@@ -294,11 +397,11 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                 */
                 
                 
-                nIterations_bisect = 0;
-                while ((abserr > absTol || funcerr > funcTol) && nIterations_bisect<maxIts) {
+                its_bisect = 0;
+                while ((abserr > absTol || funcerr > funcTol) && its_bisect<maxIts) {
                 /* Undertake iteration using Bisection method*/                 
                     
-                    /* mexPrintf("%s%d\n", "      ... Doing bi-section iteration ", nIterations_bisect);                    
+                    /* mexPrintf("%s%d\n", "      ... Doing bi-section iteration ", its_bisect);                    
                     mexPrintf("%s%f%s%f%s%f\n", "          fa, f, fb:", fa," , ",f," , ",fb);                    
                      */
                     if ( fa*f < 0.0) {
@@ -337,14 +440,19 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                     mexPrintf("%s%f%s%f%s%f%\n", "          abserr, funcerr, f-f_prev:", abserr," , ",funcerr," , ",f-f_prev);                    
                      **/
                     
-                    nIterations_bisect++;
+                    its_bisect++;
 
                 }
+                nIterations_bisect = nIterations_bisect + its_bisect;
+                if (histogram_bisect != NULL)
+                    histogram_bisect[its_bisect]++;
             }                                         
         }
         nIterations = nIterations + its;                     
+        if (histogram_newton != NULL)
+            histogram_newton[its]++;
      }
     
-     plhs[1] = mxCreateDoubleScalar(nIterations);
-     plhs[2] = mxCreateDoubleScalar(nIterations_bisect);
+     *nIterations_out = nIterations;
+     *nIterations_bisect_out = nIterations_bisect;
 }
@@ -129,6 +129,29 @@ classdef derivedweighting_PearsonsPumping < responseFunction_Pearsons & derivedR
             result = theta@responseFunction_Pearsons(obj, t);              
         end   
         
+        % Get theta as a sum of exponential terms for the recursive
+        % convolution.
+        function terms = theta_recursiveTerms(obj)
+            % Set 'A' from the S value from the pumping drawdown eqn
+            setA(obj);            
+            
+            % Call the Pearsonss model terms function
+            terms = theta_recursiveTerms@responseFunction_Pearsons(obj);
+        end
+        
+        % Calculate the derivative of the impulse-response function with
+        % respect to the parameters b and n. 'A' is not a parameter of
+        % this function (it is derived from the source pumping function)
+        % and so its column is removed.
+        function result = dtheta_dp(obj, t)
+            % Set 'A' from the S value from the pumping drawdown eqn
+            setA(obj);            
+            
+            % Call the Pearsonss model derivative function
+            result = dtheta_dp@responseFunction_Pearsons(obj, t);
+            result = result(:,2:3);
+        end
+        
         % Calculate integral of impulse-response function from t to inf.
         % This is used to minimise the impact from a finit forcign data
         % set.
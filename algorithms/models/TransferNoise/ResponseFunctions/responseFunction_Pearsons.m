@@ -229,6 +229,38 @@ classdef responseFunction_Pearsons < responseFunction_abstract
             result(t==0,:) = 0;
         end   
         
+        % Get theta as a sum of exponential terms for the recursive
+        % convolution. This is only possible when the shape parameter, 
+        % 10^n, is an integer. For 10^n>1, theta = C .* t.^(10^n-1) .* exp(-b.*t) 
+        % where C is A divided by the non-scaled peak. For 10^n=1, theta 
+        % is an exponential minus the weight at the lower limit (ie a 
+        % constant). theta() must be called prior so that the weight at
+        % the lower limit is set.
+        function terms = theta_recursiveTerms(obj)
+            
+            % Back transform parameters.
+            n_backTrans = 10^(obj.n);
+            b_backTrans = 10^(obj.b);
+            A_backTrans = 10^(obj.A);
+            
+            terms = [];
+            if abs(n_backTrans - round(n_backTrans)) > 1e-10
+                return
+            end
+            
+            if n_backTrans > 1
+                t_peak = (n_backTrans - 1)/b_backTrans;
+                C = A_backTrans ./(t_peak.^(n_backTrans-1)*exp(-b_backTrans*t_peak));
+                if ~isinf(C) && ~isnan(C) && C~=0
+                    terms = [C, b_backTrans, round(n_backTrans)-1];
+                end
+            elseif ~isnan(obj.settings.weight_at_limit)
+                w = obj.settings.weight_at_limit;
+                terms = [A_backTrans./(1-w), b_backTrans, 0; ...
+                        -A_backTrans.*w./(1-w), 0, 0];
+            end
+        end
+        
         function [result, A_backTrans] = theta_normalised(obj, t)
             % Get non-normalised theta result
             result = theta(obj, t);
@@ -240,6 +272,47 @@ classdef responseFunction_Pearsons < responseFunction_abstract
             % value)
             result  = result ./ A_backTrans;
         end
+        
+        % Calculate the derivative of the impulse-response function with
+        % respect to the (log10 transformed) parameters A, b and n.
+        function result = dtheta_dp(obj, t)
+            
+            % Back transform parameters.
+            n_backTrans = 10^(obj.n);
+            b_backTrans = 10^(obj.b);
+            A_backTrans = 10^(obj.A);
+            
+            % Calculate theta. This also updates the weight at the lower
+            % limit to an exponential response function.
+            theta_t = theta(obj, t);
+            
+            result = zeros(size(t,1), 3);
+            result(:,1) = log(10) .* theta_t;
+            if n_backTrans > 1
+                % When rearranged, theta = A .* (b.*t./(n-1)).^(n-1) .* exp(n-1-b.*t). 
+                % Hence, dtheta/db = theta .* ((n-1)./b - t) and
+                % dtheta/dn = theta .* log(b.*t./(n-1)).
+                result(:,2) = log(10) .* b_backTrans .* theta_t .* ((n_backTrans - 1)./b_backTrans - t);
+                result(:,3) = log(10) .* n_backTrans .* theta_t .* log(b_backTrans .* t./(n_backTrans - 1));
+            else
+                % theta = A./(1-w) .* (g - w) where g = t.^(n-1) .* exp(-b.*t) 
+                % and w is g at t_limit.
+                g = t.^(n_backTrans-1) .* exp( -b_backTrans .* t );
+                w = obj.settings.weight_at_limit;
+                
+                dg = -t.*g;
+                dw = -obj.settings.t_limit .* w;
+                result(:,2) = log(10) .* b_backTrans .* A_backTrans .* ((dg - dw).*(1-w) + (g - w).*dw)./(1-w).^2;
+
+                dg = log(t).*g;
+                dw = log(obj.settings.t_limit) .* w;
+                result(:,3) = log(10) .* n_backTrans .* A_backTrans .* ((dg - dw).*(1-w) + (g - w).*dw)./(1-w).^2;
+            end
+            
+            % Set the derivative at the first time point to zero (as per
+            % theta).
+            result(t==0,:) = 0;
+        end
             
         % Calculate integral of impulse-response function from t to inf.
         % This is used to minimise the impact from a finit forcign data
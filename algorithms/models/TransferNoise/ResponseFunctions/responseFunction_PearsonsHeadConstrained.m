@@ -87,6 +87,13 @@ end
             delta_t = [0;diff(h_star_est(:,1))];
             result = h_star_est(:,end) - max(0,h_star_est(:,end) - 10.^obj.threshold).*10.^(obj.k).*delta_t;
         end
+        
+        % The head constraint transformation is nonlinear and so the
+        % derivative of theta can not be used to derive the sensitivity of
+        % h_star.
+        function result = dtheta_dp(obj, t) %#ok<INUSD> 
+            result = [];
+        end
 
         function delete(obj)
 % delete class destructor
@@ -41,6 +41,27 @@ classdef responseFunction_PearsonsNegative < responseFunction_Pearsons
             result = -theta@responseFunction_Pearsons(obj, t);          
         end   
 
+        % Get theta as a sum of exponential terms for the recursive
+        % convolution. The sign of the coefficients is changed.
+        function terms = theta_recursiveTerms(obj)
+            terms = theta_recursiveTerms@responseFunction_Pearsons(obj);
+            if ~isempty(terms)
+                terms(:,1) = -terms(:,1);
+            end
+        end
+
+        % Calculate the derivative of the impulse-response function with
+        % respect to the parameters. The inherited method derives the
+        % derivatives from theta(), and hence has the sign changed, except
+        % for the b and n derivatives when 10^n<=1, which are derived from
+        % A. The sign of these is changed here.
+        function result = dtheta_dp(obj, t)
+            result = dtheta_dp@responseFunction_Pearsons(obj, t);
+            if 10^(obj.n) <= 1
+                result(:,2:3) = -result(:,2:3);
+            end
+        end
+        
         % Calculate integral of impulse-response function from 0 to 1.
         function result = intTheta_lowerTail(obj, t)           
             % Call the source model intTheta function and change the sign of
@@ -50,5 +50,63 @@ classdef responseFunction_abstract < handle
         
     end
     
+    methods
+        % Calculate the derivative of the impulse-response function with
+        % respect to each parameter (one column per parameter). This is 
+        % used to derive the sensitivity of h_star to the parameters (see
+        % model_TFN.getJacobian). Response functions having an analytical
+        % derivative should overload this method. An empty result denotes
+        % that the derivative is not available.
+        function result = dtheta_dp(obj, t) %#ok<INUSD> 
+            result = [];
+        end
+        
+        % Calculate the derivative of the upper tail integral (one row per
+        % parameter) and the lower tail integral (one value per parameter)
+        % with respect to each parameter. Central differences are used
+        % because the tail integrals (eg incomplete gamma functions) are
+        % not readily differentiated with respect to all parameters.
+        function [dIntTheta_upperTail, dIntTheta_lowerTail] = dIntTheta_dp(obj, t_upper, t_lower)
+            params = getParameters(obj);
+            nParams = size(params,1);
+            dIntTheta_upperTail = zeros(nParams, numel(t_upper));
+            dIntTheta_lowerTail = zeros(nParams, 1);
+            for i=1:nParams
+                delta = 1e-6 * max(1, abs(params(i)));
+                
+                params_delta = params;
+                params_delta(i) = params(i) + delta;
+                setParameters(obj, params_delta);
+                theta(obj, t_lower);
+                intTheta_upper = intTheta_upperTail2Inf(obj, t_upper);
+                intTheta_lower = intTheta_lowerTail(obj, t_lower);
+                
+                params_delta(i) = params(i) - delta;
+                setParameters(obj, params_delta);
+                theta(obj, t_lower);
+                dIntTheta_upperTail(i,:) = (intTheta_upper - intTheta_upperTail2Inf(obj, t_upper)) ./ (2*delta);
+                dIntTheta_lowerTail(i) = (intTheta_lower - intTheta_lowerTail(obj, t_lower)) ./ (2*delta);
+            end
+            
+            % Reset the parameters. theta() is called to reset any
+            % variables derived from the parameters.
+            setParameters(obj, params);
+            theta(obj, t_lower);
+        end
+        
+        % Get theta as a sum of terms c .* t.^m .* exp(-a .* t), where m is
+        % a non-negative integer and a>=0. The result is an nTerms x 3
+        % matrix of [c, a, m]. If the terms are returned, model_TFN.get_h_star
+        % undertakes the convolution recursively (see doIRFconvolution.c),
+        % which is far faster for long forcing records. Response functions
+        % that can be represented by such terms should overload this 
+        % method. An empty result denotes that theta cannot be represented 
+        % and the non-recursive convolution is then used. theta() is called
+        % prior to this method.
+        function terms = theta_recursiveTerms(obj) %#ok<MANU> 
+            terms = [];
+        end
+    end
+    
 end
 
@@ -0,0 +1,1138 @@
+/* TFN_batch - native (ie without MATLAB) batch simulation of calibrated transfer function noise models.
+ *
+ * For each bore listed within the parameter file, the soil moisture model is
+ * run, the transformed forcing of each model component is convolved with
+ * the component's Pearson's response function and then the noise model is
+ * applied. The bores are simulated in parallel using OpenMP. The numerical
+ * kernels are those used by the MEX files (see algorithms/hydroSightKernels.h)
+ * and the steps replicate model_TFN.get_h_star() and model_TFN.solve() for
+ * the following model structure:
+ *   - climateTransform_soilMoistureModels (single layer, no land cover
+ *     change, bypass flow or runoff) with a daily time step;
+ *   - responseFunction_Pearsons or responseFunction_PearsonsNegative for
+ *     each component;
+ *   - the exponential noise model.
+ *
+ * Build (from the HydroSight root folder):
+      gcc -O2 -fopenmp -o TFN_batch algorithms/models/TransferNoise/batch/TFN_batch.c \
+          algorithms/models/TransferNoise/doIRFconvolution.c \
+          algorithms/models/TransferNoise/ForcingTransformation/forcingTransform_soilMoisture.c \
+          algorithms/models/ExpSmooth/doExpSmoothing.c \
+          algorithms/utilities/timeSeriesStore.c -lm
+ *
+ * Usage:
+      ./TFN_batch parameterFile [--threads n] [--summary file]
+ *
+ *   --threads  Number of OpenMP threads (default: all cores).
+ *   --summary  File for the summary of each bore (default: standard output).
+ *
+ * Parameter file:
+ *   The file lists each bore within a block that starts with [bore ID].
+ *   File names are relative to the folder of the parameter file. Lines
+ *   starting with # are comments. For example:
+ *
+ *     [bore ID124705]
+ *     forcing = 124705_forcing.csv
+ *     head = 124705_head.csv
+ *     output = results/124705_simulation.csv
+ *     soil = SMSC 150.2 k_sat 12.5 alpha 0 beta 3.1 gamma 1
+ *     component = drainage Pearsons -2.04 -2.61 0.12
+ *     component = evap_gw_potential PearsonsNegative -3.1 -2.5 -0.3
+ *     noise_alpha = -1.2
+ *     d = 102.35
+ *
+ *   forcing    CSV file of daily forcing with the columns year, month, day,
+ *              precip, et and, optionally, temperature. If a store is input,
+ *              the site within the store (see below).
+ *   head       Optional CSV file of observed head with the columns year,
+ *              month, day and head. If it has 7 or more columns then the
+ *              columns are year, month, day, hour, minute, second and head.
+ *              The simulation time points are the observation times. If not
+ *              input, the time points are daily. If a store is input, the
+ *              site within the store.
+ *   store      Optional time series store (see algorithms/timeSeriesStore.h).
+ *              The forcing site must have the variables precip, et and,
+ *              optionally, temp, and the head site the variable head. Each
+ *              store is mapped once and the bores read the forcing and head
+ *              directly from the mapping.
+ *   output     CSV file for the simulation results.
+ *   soil       The soil moisture model parameters, as returned by
+ *              climateTransform_soilMoistureModels.getDerivedParameters().
+ *              SMSC, k_sat, alpha, beta and gamma are required. S_initialfrac
+ *              (default 1), k_infilt (inf), interflow_frac (0), eps (0), DDF
+ *              and melt_threshold (nan, ie no snow) are optional.
+ *   component  The forcing, response function and the response function
+ *              parameters A, b and n (as within the calibrated model, ie log10).
+ *              The forcing is one of precip, et, effectivePrecip, drainage,
+ *              interflow, evap_soil or evap_gw_potential. The response
+ *              function is Pearsons or PearsonsNegative.
+ *   noise_alpha  The noise parameter alpha (log10).
+ *   d          Optional drainage elevation. If not input, it is derived from
+ *              the observed head (as per model_TFN.objectiveFunction()).
+ *   sigma_n    Optional noise standard deviation. If not input, it is derived
+ *              from the observed head (as per model_TFN.calibration_finalise()).
+ *
+ * Output:
+ *   The output file for each bore has the columns year, month, day, the
+ *   contribution from each component, the simulated head, the lower and upper
+ *   noise bounds (ie the 5th and 95th percentiles) and, if observed, the
+ *   observed head. The summary has one row per bore of the status, number
+ *   of days, number of time points, d, sigma_n, the objective function (if
+ *   observed head is input) and the run time.
+ *
+ * Note, the last forcing day is required for the integration of the day
+ * prior and so no output time points are produced for it.
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "ctype.h"
+#include "time.h"
+#ifdef _WIN32
+#include "windows.h"
+#endif
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+#include "../../../hydroSightKernels.h"
+#include "../../../timeSeriesStore.h"
+
+#define MAX_COMPONENTS 8
+#define MAX_PATH_LENGTH 1024
+#define MAX_LINE_LENGTH 4096
+#define MAX_MESSAGE_LENGTH (MAX_PATH_LENGTH + 256)
+#define TILE_SIZE 64
+#define DATENUM_1970 719529.0
+#define NORMINV_95 1.6448536269514722
+#define INTEGER_SHAPE_TOLERANCE 1e-10
+
+#define FORCING_PRECIP 0
+#define FORCING_ET 1
+#define FORCING_EFFECTIVEPRECIP 2
+#define FORCING_DRAINAGE 3
+#define FORCING_INTERFLOW 4
+#define FORCING_EVAP_SOIL 5
+#define FORCING_EVAP_GW_POTENTIAL 6
+
+static const char *forcingNames[] = {"precip", "et", "effectivePrecip", "drainage", "interflow", "evap_soil",
+        "evap_gw_potential"};
+static const int nForcingNames = 7;
+
+typedef struct {
+    int forcing;
+    int isNegative;
+    double A, b, n;
+} componentSettings;
+
+typedef struct {
+    char boreID[MAX_MESSAGE_LENGTH];
+    char forcingFile[MAX_PATH_LENGTH], headFile[MAX_PATH_LENGTH], outputFile[MAX_PATH_LENGTH], storeFile[MAX_PATH_LENGTH];
+    int storeIndex;
+    double SMSC, S_initialfrac, k_infilt, k_sat, interflow_frac, alpha, beta, gamma, eps, DDF, melt_threshold;
+    int nComponents;
+    componentSettings component[MAX_COMPONENTS];
+    double noise_alpha, d, sigma_n;
+} boreSettings;
+
+typedef struct {
+    int status;
+    char message[MAX_MESSAGE_LENGTH];
+    int nDays, nTimePoints;
+    double d, sigma_n, objFn, runTime;
+} boreResult;
+
+/* Data read from a CSV file. */
+typedef struct {
+    int nRows, nCols;
+    double *data;
+} tableData;
+
+static double getTime(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1.0e-9 * (double) t.tv_nsec;
+#endif
+}
+
+/* Conversion between dates and MATLAB date numbers. */
+static double datenum(const int year, const int month, const int day)
+{
+    const int y = year - (month <= 2);
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (double) era * 146097.0 + (double) doe - 719468.0 + DATENUM_1970;
+}
+
+static void datevec(const double t, int *year, int *month, int *day)
+{
+    const long z = (long) floor(t - DATENUM_1970) + 719468;
+    const long era = (z >= 0 ? z : z - 146096) / 146097;
+    const long doe = z - era * 146097;
+    const long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const long mp = (5 * doy + 2) / 153;
+    *day = (int) (doy - (153 * mp + 2) / 5 + 1);
+    *month = (int) (mp < 10 ? mp + 3 : mp - 9);
+    *year = (int) (yoe + era * 400 + (*month <= 2));
+}
+
+/* Get the next token of the string at *cursor that is delimited by any of
+ * the delimiters, or NULL if there are no more tokens, and advance *cursor
+ * past it. Unlike strtok() no state is kept between calls and so the files
+ * of the bores can be read by multiple threads at once. */
+static char *nextToken(char **cursor, const char *delimiters)
+{
+    char *token = *cursor + strspn(*cursor, delimiters);
+    if (*token == '\0') {
+        *cursor = token;
+        return NULL;
+    }
+    *cursor = token + strcspn(token, delimiters);
+    if (**cursor != '\0') {
+        **cursor = '\0';
+        (*cursor)++;
+    }
+    return token;
+}
+
+/* Read a numeric CSV file. Rows that do not start with a number (eg a
+ * header) are skipped and all rows must have the same number of columns. */
+static int readTable(const char *fileName, tableData *table, char *message)
+{
+    FILE *fid;
+    char line[MAX_LINE_LENGTH], *token, *endPtr, *cursor;
+    int nCols, capacity = 0;
+    double value;
+
+    table->nRows = 0;
+    table->nCols = 0;
+    table->data = NULL;
+
+    fid = fopen(fileName, "r");
+    if (fid == NULL) {
+        snprintf(message, MAX_MESSAGE_LENGTH, "The file could not be opened: %s", fileName);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), fid) != NULL) {
+        cursor = line;
+        token = nextToken(&cursor, ", \t\r\n");
+        if (token == NULL || (strtod(token, &endPtr), endPtr == token))
+            continue;
+
+        nCols = 0;
+        while (token != NULL) {
+            value = strtod(token, &endPtr);
+            if (endPtr == token)
+                value = NAN;
+            if (table->nRows == 0 && nCols >= table->nCols)
+                table->nCols = nCols + 1;
+            if (nCols < table->nCols) {
+                if ((table->nRows + 1) * table->nCols > capacity) {
+                    capacity = 2 * (table->nRows + 1) * table->nCols;
+                    table->data = (double *) realloc(table->data, capacity * sizeof(double));
+                }
+                table->data[table->nRows * table->nCols + nCols] = value;
+            }
+            nCols++;
+            token = nextToken(&cursor, ", \t\r\n");
+        }
+        if (nCols != table->nCols) {
+            snprintf(message, MAX_MESSAGE_LENGTH, "Row %d of %s has an inconsistent number of columns.", table->nRows + 1, fileName);
+            fclose(fid);
+            return 0;
+        }
+        table->nRows++;
+    }
+    fclose(fid);
+
+    if (table->nRows == 0) {
+        snprintf(message, MAX_MESSAGE_LENGTH, "The file contains no data: %s", fileName);
+        return 0;
+    }
+    return 1;
+}
+
+/* Regularised upper incomplete gamma function, ie MATLAB's gammainc(x,a,'upper'). */
+static double gammaincUpper(const double a, const double x)
+{
+    const double tiny = 1.0e-300, tol = 1.0e-15;
+    double sum, term, ap, b, c, d, h, delta;
+    int i;
+
+    if (x <= 0.0)
+        return 1.0;
+    if (isinf(x))
+        return 0.0;
+
+    if (x < a + 1.0) {
+        /* Series for the lower incomplete gamma function. */
+        ap = a;
+        term = 1.0 / a;
+        sum = term;
+        for (i = 0; i < 10000; i++) {
+            ap += 1.0;
+            term *= x / ap;
+            sum += term;
+            if (fabs(term) < fabs(sum) * tol)
+                break;
+        }
+        return 1.0 - sum * exp(-x + a * log(x) - lgamma(a));
+    }
+    else {
+        /* Continued fraction (modified Lentz's method). */
+        b = x + 1.0 - a;
+        c = 1.0 / tiny;
+        d = 1.0 / b;
+        h = d;
+        for (i = 1; i < 10000; i++) {
+            term = -i * (i - a);
+            b += 2.0;
+            d = term * d + b;
+            if (fabs(d) < tiny)
+                d = tiny;
+            c = b + term / c;
+            if (fabs(c) < tiny)
+                c = tiny;
+            d = 1.0 / d;
+            delta = d * c;
+            h *= delta;
+            if (fabs(delta - 1.0) < tol)
+                break;
+        }
+        return exp(-x + a * log(x) - lgamma(a)) * h;
+    }
+}
+
+/* Pearson's response function, as per responseFunction_Pearsons. theta is
+ * derived at tor (nTor values) and the integral of theta from 0 to 1 and
+ * from each tor_end to infinity are derived. The lower limit to the
+ * exponential-like response function (ie n<=1) is 100 years prior to the
+ * maximum tor. If n is an integer then theta is also returned as terms for
+ * convolution_recursive() (at most 2 x 3), as per 
+ * responseFunction_Pearsons.theta_recursiveTerms(). Else nTerms is zero. */
+static void pearsons(const componentSettings *component, const double *tor, const int nTor, const double *tor_end,
+        const int nTorEnd, double *theta, double *intTheta_lowerTail, double *intTheta_upperTail, double *terms, int *nTerms)
+{
+    const double n = pow(10.0, component->n), b = pow(10.0, component->b), A = pow(10.0, component->A);
+    const double sign = component->isNegative ? -1.0 : 1.0;
+    double t_peak, theta_peak, t_limit, weight_at_limit, scale, Q_limit;
+    int i, isValid;
+
+    if (n > 1.0) {
+        t_peak = (n - 1.0) / b;
+        isValid = 1;
+        for (i = 0; i < nTor; i++) {
+            theta[i] = A / (pow(t_peak, n - 1.0) * exp(-b * t_peak)) * pow(tor[i], n - 1.0) * exp(-b * tor[i]);
+            isValid = isValid && isfinite(theta[i]);
+        }
+
+        /* Rearranged version that minimises Inf and NaN values when n is large. */
+        if (!isValid)
+            for (i = 0; i < nTor; i++)
+                theta[i] = A * pow(tor[i] * b / (n - 1.0) * exp(1.0) * exp(-b * tor[i] / (n - 1.0)), n - 1.0);
+
+        theta_peak = pow(t_peak, n - 1.0) * exp(-b * t_peak);
+        if (isinf(theta_peak))
+            theta_peak = pow((n - 1.0) / b * exp(-1.0), n - 1.0);
+        scale = A * tgamma(n) / (pow(b, n) * theta_peak);
+
+        *nTerms = 0;
+        if (fabs(n - round(n)) <= INTEGER_SHAPE_TOLERANCE && isfinite(A / theta_peak) && A / theta_peak != 0.0) {
+            *nTerms = 1;
+            terms[0] = sign * A / theta_peak;
+            terms[1] = b;
+            terms[2] = round(n) - 1.0;
+        }
+
+        *intTheta_lowerTail = scale * (1.0 - gammaincUpper(n, b));
+        if (isnan(*intTheta_lowerTail) && isinf(theta_peak))
+            *intTheta_lowerTail = 0.0;
+
+        isValid = 1;
+        for (i = 0; i < nTorEnd; i++) {
+            intTheta_upperTail[i] = scale * gammaincUpper(n, b * tor_end[i]);
+            isValid = isValid && isfinite(intTheta_upperTail[i]);
+        }
+    }
+    else {
+        t_limit = 0.0;
+        for (i = 0; i < nTor; i++)
+            t_limit = tor[i] > t_limit ? tor[i] : t_limit;
+        t_limit += 365.0 * 100.0;
+        weight_at_limit = pow(t_limit, n - 1.0) * exp(-b * t_limit);
+
+        for (i = 0; i < nTor; i++)
+            theta[i] = A / (1.0 - weight_at_limit) * (pow(tor[i], n - 1.0) * exp(-b * tor[i]) - weight_at_limit);
+
+        *nTerms = 0;
+        if (fabs(n - 1.0) <= INTEGER_SHAPE_TOLERANCE) {
+            *nTerms = 2;
+            terms[0] = sign * A / (1.0 - weight_at_limit);
+            terms[1] = -sign * A * weight_at_limit / (1.0 - weight_at_limit);
+            terms[2] = b;
+            terms[3] = 0.0;
+            terms[4] = 0.0;
+            terms[5] = 0.0;
+        }
+
+        /* Note, responseFunction_Pearsons.intTheta_lowerTail() returns zero for n<=1. */
+        *intTheta_lowerTail = 0.0;
+
+        Q_limit = gammaincUpper(n, b * t_limit);
+        isValid = 1;
+        for (i = 0; i < nTorEnd; i++) {
+            intTheta_upperTail[i] = A / (1.0 - weight_at_limit) * (tgamma(n) / pow(b, n) * (gammaincUpper(n, b * tor_end[i]) - Q_limit)
+                    - weight_at_limit * (t_limit - tor_end[i]));
+            isValid = isValid && isfinite(intTheta_upperTail[i]);
+        }
+    }
+
+    if (!isValid)
+        for (i = 0; i < nTorEnd; i++)
+            intTheta_upperTail[i] = NAN;
+
+    for (i = 0; i < nTor; i++) {
+        if (tor[i] == 0.0)
+            theta[i] = 0.0;
+        theta[i] *= sign;
+    }
+    *intTheta_lowerTail *= sign;
+    for (i = 0; i < nTorEnd; i++)
+        intTheta_upperTail[i] *= sign;
+}
+
+/* Steady state soil moisture, as per climateTransform_soilMoistureModels.setTransformedForcing(). */
+static double steadyStateSoilMoisture(const boreSettings *bore, const double precipMean, const double etMean)
+{
+    double S_lower = 0.0, S_upper = bore->SMSC, S, f_lower, f;
+    int i;
+
+    #define STEADY_STATE(S) (precipMean * fmin(1.0, pow((bore->SMSC - (S)) / (bore->SMSC * (1.0 - bore->eps)), bore->alpha)) \
+            - bore->k_sat * pow((S) / bore->SMSC, bore->beta) - etMean * pow((S) / bore->SMSC, bore->gamma))
+
+    f_lower = STEADY_STATE(S_lower);
+    if (f_lower * STEADY_STATE(S_upper) > 0.0)
+        return fabs(f_lower) < fabs(STEADY_STATE(S_upper)) ? S_lower : S_upper;
+
+    S = 0.5 * (S_lower + S_upper);
+    for (i = 0; i < 200 && S_upper - S_lower > 1.0e-12 * bore->SMSC; i++) {
+        S = 0.5 * (S_lower + S_upper);
+        f = STEADY_STATE(S);
+        if (f == 0.0)
+            break;
+        if (f * f_lower < 0.0)
+            S_upper = S;
+        else {
+            S_lower = S;
+            f_lower = f;
+        }
+    }
+    #undef STEADY_STATE
+    return S;
+}
+
+/* Forcing and observed head of a bore as columns. The columns point into
+ * either the buffer of the data read from the CSV files or, if read from a
+ * store, the mapped store (ie without a copy). */
+typedef struct {
+    int nDays, nObs;
+    const double *date, *precip, *et, *temp;
+    const double *obsTime, *obsHead;
+    double *buffer;
+} boreData;
+
+/* Read the forcing and head CSV files of a bore. */
+static int readBoreFiles(const boreSettings *bore, boreData *data, char *message)
+{
+    tableData forcingTable, headTable;
+    double *column;
+    int i, k, nDays, nObs, isOK = 0;
+
+    forcingTable.data = NULL;
+    headTable.data = NULL;
+    if (!readTable(bore->forcingFile, &forcingTable, message))
+        goto cleanup;
+    if (forcingTable.nCols < 5) {
+        snprintf(message, MAX_MESSAGE_LENGTH, "The forcing file must have the columns year, month, day, precip and et.");
+        goto cleanup;
+    }
+    if (bore->headFile[0] != '\0') {
+        if (!readTable(bore->headFile, &headTable, message))
+            goto cleanup;
+        if (headTable.nCols < 4) {
+            snprintf(message, MAX_MESSAGE_LENGTH, "The head file must have the columns year, month, day and head.");
+            goto cleanup;
+        }
+    }
+
+    nDays = forcingTable.nRows;
+    nObs = headTable.data != NULL ? headTable.nRows : 0;
+    data->buffer = (double *) malloc((4 * nDays + 2 * nObs) * sizeof(double));
+    column = data->buffer;
+    for (i = 0; i < nDays; i++) {
+        k = i * forcingTable.nCols;
+        column[i] = datenum((int) forcingTable.data[k], (int) forcingTable.data[k+1], (int) forcingTable.data[k+2]);
+        column[nDays + i] = forcingTable.data[k+3];
+        column[2*nDays + i] = forcingTable.data[k+4];
+        column[3*nDays + i] = forcingTable.nCols >= 6 ? forcingTable.data[k+5] : 0.0;
+    }
+    data->nDays = nDays;
+    data->date = column;
+    data->precip = column + nDays;
+    data->et = column + 2*nDays;
+    data->temp = forcingTable.nCols >= 6 ? column + 3*nDays : NULL;
+
+    column += 4 * nDays;
+    for (i = 0; i < nObs; i++) {
+        k = i * headTable.nCols;
+        column[i] = datenum((int) headTable.data[k], (int) headTable.data[k+1], (int) headTable.data[k+2]);
+        if (headTable.nCols >= 7)
+            column[i] += (headTable.data[k+3] + (headTable.data[k+4] + headTable.data[k+5] / 60.0) / 60.0) / 24.0;
+        column[nObs + i] = headTable.data[k + headTable.nCols - 1];
+    }
+    data->nObs = nObs;
+    data->obsTime = column;
+    data->obsHead = column + nObs;
+    isOK = 1;
+
+cleanup:
+    free(forcingTable.data);
+    free(headTable.data);
+    return isOK;
+}
+
+/* Get the forcing and head of a bore from the store. The forcing site must
+ * have the variables precip, et and, optionally, temp with the same dates
+ * and the head site must have the variable head. */
+static int readBoreStore(const boreSettings *bore, const tsStore *store, boreData *data, char *message)
+{
+    const char *variables[] = {"precip", "et", "temp"};
+    const double *columns[3];
+    int i, j;
+
+    for (j = 0; j < 3; j++) {
+        columns[j] = NULL;
+        i = tsStore_find(store, bore->forcingFile, variables[j]);
+        if (i < 0 && j == 2)
+            continue;
+        if (i < 0) {
+            snprintf(message, MAX_MESSAGE_LENGTH, "The store does not contain the variable %s for the site %s.", variables[j], bore->forcingFile);
+            return 0;
+        }
+        if (j == 0) {
+            data->nDays = (int) tsStore_length(store, i);
+            data->date = tsStore_time(store, i);
+        }
+        else if ((int) tsStore_length(store, i) != data->nDays || (tsStore_time(store, i) != data->date
+        && memcmp(tsStore_time(store, i), data->date, data->nDays * sizeof(double)) != 0)) {
+            snprintf(message, MAX_MESSAGE_LENGTH, "The forcing variables of the site %s do not have the same dates.", bore->forcingFile);
+            return 0;
+        }
+        columns[j] = tsStore_values(store, i);
+    }
+    data->precip = columns[0];
+    data->et = columns[1];
+    data->temp = columns[2];
+
+    if (bore->headFile[0] != '\0') {
+        i = tsStore_find(store, bore->headFile, "head");
+        if (i < 0) {
+            snprintf(message, MAX_MESSAGE_LENGTH, "The store does not contain the variable head for the site %s.", bore->headFile);
+            return 0;
+        }
+        data->nObs = (int) tsStore_length(store, i);
+        data->obsTime = tsStore_time(store, i);
+        data->obsHead = tsStore_values(store, i);
+    }
+    return 1;
+}
+
+/* Simulate one bore. */
+static void simulateBore(const boreSettings *bore, const tsStore *stores, boreResult *result)
+{
+    boreData data;
+    double *precip = NULL, *precip_sub = NULL, *et_sub = NULL, *temp_sub = NULL, *SMS = NULL, *forcing = NULL;
+    double *time_points = NULL, *h_obs = NULL, *h_star = NULL, *h_component = NULL, *tor = NULL, *theta = NULL;
+    double *theta_indexes_start = NULL, *tor_end = NULL, *intTheta_upperTail = NULL, *resid = NULL;
+    double t0, t, forcingMean, precipMean, etMean, intTheta_lowerTail, S0, frac_i, frac_j, lambda_p;
+    double h_bar, h_star_mean, alpha_n, delta_t, innov, weight, sumLogWeight, sumInnov, sigma2, terms[6];
+    unsigned int nIterations, nIterations_bisect;
+    int i, j, nDays, nTimePoints, ntor, ntheta, hasTemp, hasSnow, hasHead, isRead, year, month, day, nTerms;
+    FILE *fid;
+
+    t0 = getTime();
+    memset(result, 0, sizeof(boreResult));
+    memset(&data, 0, sizeof(boreData));
+    result->d = NAN;
+    result->sigma_n = NAN;
+    result->objFn = NAN;
+
+    /* Get the forcing and head data and check the forcing is daily. */
+    if (bore->storeIndex >= 0)
+        isRead = readBoreStore(bore, stores + bore->storeIndex, &data, result->message);
+    else
+        isRead = readBoreFiles(bore, &data, result->message);
+    if (!isRead)
+        goto cleanup;
+    nDays = data.nDays;
+    hasTemp = data.temp != NULL;
+    hasSnow = hasTemp && isfinite(bore->DDF) && isfinite(bore->melt_threshold);
+    result->nDays = nDays;
+    for (i = 1; i < nDays; i++) {
+        if (data.date[i] != data.date[0] + i) {
+            snprintf(result->message, MAX_MESSAGE_LENGTH, "The forcing data must be daily without gaps (see row %d).", i + 1);
+            goto cleanup;
+        }
+    }
+    if (nDays < 3) {
+        snprintf(result->message, MAX_MESSAGE_LENGTH, "At least three days of forcing data are required.");
+        goto cleanup;
+    }
+    t = data.date[0];
+
+    /* Derive the output time points. The last forcing day is excluded (see above). */
+    hasHead = bore->headFile[0] != '\0';
+    if (hasHead) {
+        time_points = (double *) malloc((data.nObs > 0 ? data.nObs : 1) * sizeof(double));
+        h_obs = (double *) malloc((data.nObs > 0 ? data.nObs : 1) * sizeof(double));
+        nTimePoints = 0;
+        for (i = 0; i < data.nObs; i++) {
+            time_points[nTimePoints] = data.obsTime[i];
+            h_obs[nTimePoints] = data.obsHead[i];
+            if (time_points[nTimePoints] >= t && time_points[nTimePoints] < t + nDays - 1 && isfinite(h_obs[nTimePoints]))
+                nTimePoints++;
+        }
+        if (nTimePoints < 2) {
+            snprintf(result->message, MAX_MESSAGE_LENGTH, "Less than two head observations are within the forcing period.");
+            goto cleanup;
+        }
+    }
+    else {
+        nTimePoints = nDays - 1;
+        time_points = (double *) malloc(nTimePoints * sizeof(double));
+        for (i = 0; i < nTimePoints; i++)
+            time_points[i] = t + i;
+    }
+    result->nTimePoints = nTimePoints;
+
+    /* Derive the effective precipitation (ie limited by the infiltration capacity). */
+    precip = (double *) malloc(nDays * sizeof(double));
+    for (i = 0; i < nDays; i++) {
+        precip[i] = data.precip[i];
+        if (isfinite(bore->k_infilt) && precip[i] > 0.0) {
+            lambda_p = 0.2 * bore->k_infilt;
+            precip[i] = precip[i] + lambda_p * log(1.0 / (1.0 + exp((precip[i] - bore->k_infilt) / lambda_p)));
+            if (isinf(precip[i]))
+                precip[i] = bore->k_infilt;
+        }
+        else if (!(precip[i] > 0.0))
+            precip[i] = 0.0;
+    }
+
+    /* Run the soil moisture model. As per getSubDailyForcing(), the inputs
+     * are preceded by a dummy value for the initial condition. */
+    precip_sub = (double *) calloc(nDays + 1, sizeof(double));
+    et_sub = (double *) calloc(nDays + 1, sizeof(double));
+    temp_sub = (double *) calloc(nDays + 1, sizeof(double));
+    SMS = (double *) malloc((nDays + 1) * sizeof(double));
+    precipMean = 0.0;
+    etMean = 0.0;
+    for (i = 0; i < nDays; i++) {
+        precip_sub[i+1] = precip[i];
+        et_sub[i+1] = data.et[i];
+        temp_sub[i+1] = hasTemp ? data.temp[i] : 0.0;
+        precipMean += precip_sub[i+1];
+        etMean += et_sub[i+1];
+    }
+    precipMean /= nDays + 1;
+    etMean /= nDays + 1;
+    S0 = steadyStateSoilMoisture(bore, precipMean, etMean);
+    S0 = fmin(fmax(0.0, S0 * bore->S_initialfrac), bore->SMSC);
+    soilMoistureModel(nDays + 1, S0, precip_sub, et_sub, temp_sub, bore->SMSC, bore->k_sat, bore->alpha, bore->beta,
+            bore->gamma, bore->eps, hasSnow ? bore->DDF : NAN, hasSnow ? bore->melt_threshold : NAN, SMS,
+            &nIterations, &nIterations_bisect, NULL, NULL);
+
+    /* Setup tor and the theta index for each time point, as per
+     * model_TFN.solve() and model_TFN.get_h_star(). */
+    ntor = (int) floor(time_points[nTimePoints-1] - t + 1.0) + 1;
+    tor = (double *) malloc(ntor * sizeof(double));
+    for (i = 0; i < ntor; i++)
+        tor[i] = ntor - 1 - i;
+    theta_indexes_start = (double *) malloc(nTimePoints * sizeof(double));
+    tor_end = (double *) malloc(nTimePoints * sizeof(double));
+    for (i = 0; i < nTimePoints; i++) {
+        ntheta = (int) floor(time_points[i] - t) + 1;
+        theta_indexes_start[i] = ntor - ntheta;
+        tor_end[i] = tor[ntor - ntheta - 1];
+    }
+
+    /* Derive the contribution from each component. */
+    forcing = (double *) malloc(nDays * sizeof(double));
+    theta = (double *) malloc(ntor * sizeof(double));
+    intTheta_upperTail = (double *) malloc(nTimePoints * sizeof(double));
+    h_component = (double *) calloc(nTimePoints * bore->nComponents, sizeof(double));
+    h_star = (double *) calloc(nTimePoints, sizeof(double));
+    for (j = 0; j < bore->nComponents; j++) {
+
+        /* Get the forcing. The soil fluxes are integrated to daily using the
+         * trapazoidal rule, as per climateTransform_soilMoistureModels.dailyIntegration(). */
+        forcingMean = 0.0;
+        for (i = 0; i < nDays; i++) {
+            frac_i = SMS[i] / bore->SMSC;
+            frac_j = SMS[i+1] / bore->SMSC;
+            switch (bore->component[j].forcing) {
+                case FORCING_PRECIP:
+                    forcing[i] = data.precip[i];
+                    break;
+                case FORCING_ET:
+                    forcing[i] = et_sub[i+1];
+                    break;
+                case FORCING_EFFECTIVEPRECIP:
+                    forcing[i] = precip[i];
+                    break;
+                case FORCING_DRAINAGE:
+                    forcing[i] = 0.5 * (1.0 - bore->interflow_frac) * bore->k_sat * (pow(frac_i, bore->beta) + pow(frac_j, bore->beta));
+                    break;
+                case FORCING_INTERFLOW:
+                    forcing[i] = 0.5 * bore->interflow_frac * bore->k_sat * (pow(frac_i, bore->beta) + pow(frac_j, bore->beta));
+                    break;
+                case FORCING_EVAP_SOIL:
+                    forcing[i] = 0.5 * et_sub[i+1] * (pow(frac_i, bore->gamma) + pow(frac_j, bore->gamma));
+                    break;
+                case FORCING_EVAP_GW_POTENTIAL:
+                    forcing[i] = et_sub[i+1] - 0.5 * et_sub[i+1] * (pow(frac_i, bore->gamma) + pow(frac_j, bore->gamma));
+                    break;
+            }
+            forcingMean += forcing[i];
+        }
+        forcingMean /= nDays;
+
+        /* Convolve the forcing with the response function. The forcing is
+         * a daily integral and so the trapazoidal rule is used. If the shape
+         * parameter is an integer then the recursive convolution is used. */
+        pearsons(&bore->component[j], tor, ntor, tor_end, nTimePoints, theta, &intTheta_lowerTail, intTheta_upperTail,
+                terms, &nTerms);
+        if (nTerms == 0 || !convolution_recursive(nTerms, terms, theta, ntor, theta_indexes_start, nTimePoints, ntor + 1,
+                forcing, nDays, 1, intTheta_lowerTail, intTheta_upperTail, forcingMean, h_component + j * nTimePoints))
+            convolution_streaming(theta, theta_indexes_start, nTimePoints, ntor + 1, forcing, 1, intTheta_lowerTail,
+                    intTheta_upperTail, forcingMean, TILE_SIZE, h_component + j * nTimePoints, ntor, 0, NULL, NULL, NULL, NULL);
+
+        for (i = 0; i < nTimePoints; i++)
+            h_star[i] += h_component[j * nTimePoints + i];
+    }
+
+    /* Add the drainage elevation. If not input, it is derived such that the
+     * mean noise is zero. */
+    result->d = bore->d;
+    if (isnan(result->d)) {
+        if (!hasHead) {
+            snprintf(result->message, MAX_MESSAGE_LENGTH, "The drainage elevation, d, must be input when no head observations are input.");
+            goto cleanup;
+        }
+        h_bar = 0.0;
+        h_star_mean = 0.0;
+        for (i = 0; i < nTimePoints; i++) {
+            h_bar += h_obs[i];
+            h_star_mean += h_star[i];
+        }
+        result->d = (h_bar - h_star_mean) / nTimePoints;
+    }
+    for (i = 0; i < nTimePoints; i++)
+        h_star[i] += result->d;
+
+    /* Derive the innovations, the noise standard deviation and the objective
+     * function, as per model_TFN.objectiveFunction() and calibration_finalise(). */
+    result->sigma_n = bore->sigma_n;
+    if (hasHead) {
+        alpha_n = pow(10.0, bore->noise_alpha);
+        resid = (double *) malloc(nTimePoints * sizeof(double));
+        for (i = 0; i < nTimePoints; i++)
+            resid[i] = h_obs[i] - h_star[i];
+
+        sumLogWeight = 0.0;
+        for (i = 1; i < nTimePoints; i++)
+            sumLogWeight += log(1.0 - exp(-2.0 * alpha_n * (time_points[i] - time_points[i-1])));
+        sumLogWeight = exp(sumLogWeight / (nTimePoints - 1));
+
+        sumInnov = 0.0;
+        sigma2 = 0.0;
+        for (i = 1; i < nTimePoints; i++) {
+            delta_t = time_points[i] - time_points[i-1];
+            innov = resid[i] - resid[i-1] * exp(-alpha_n * delta_t);
+            weight = 1.0 - exp(-2.0 * alpha_n * delta_t);
+            sumInnov += sumLogWeight / weight * innov * innov;
+            sigma2 += innov * innov / weight;
+        }
+        result->objFn = sumInnov;
+        if (isnan(result->sigma_n))
+            result->sigma_n = sqrt(sigma2 / (nTimePoints - 1));
+    }
+
+    /* Write the results. */
+    fid = fopen(bore->outputFile, "w");
+    if (fid == NULL) {
+        snprintf(result->message, MAX_MESSAGE_LENGTH, "The output file could not be created: %s", bore->outputFile);
+        goto cleanup;
+    }
+    fprintf(fid, "year,month,day");
+    for (j = 0; j < bore->nComponents; j++)
+        fprintf(fid, ",%s", forcingNames[bore->component[j].forcing]);
+    fprintf(fid, ",h_star,h_lower,h_upper%s\n", hasHead ? ",h_obs" : "");
+    for (i = 0; i < nTimePoints; i++) {
+        datevec(time_points[i], &year, &month, &day);
+        fprintf(fid, "%d,%d,%d", year, month, day);
+        for (j = 0; j < bore->nComponents; j++)
+            fprintf(fid, ",%.6f", h_component[j * nTimePoints + i]);
+        fprintf(fid, ",%.6f,%.6f,%.6f", h_star[i], h_star[i] - NORMINV_95 * result->sigma_n, h_star[i] + NORMINV_95 * result->sigma_n);
+        if (hasHead)
+            fprintf(fid, ",%.6f", h_obs[i]);
+        fprintf(fid, "\n");
+    }
+    fclose(fid);
+    result->status = 1;
+
+cleanup:
+    free(data.buffer);
+    free(precip);
+    free(precip_sub);
+    free(et_sub);
+    free(temp_sub);
+    free(SMS);
+    free(forcing);
+    free(time_points);
+    free(h_obs);
+    free(h_star);
+    free(h_component);
+    free(tor);
+    free(theta);
+    free(theta_indexes_start);
+    free(tor_end);
+    free(intTheta_upperTail);
+    free(resid);
+    result->runTime = getTime() - t0;
+}
+
+/* Trim leading and trailing white space. */
+static char *trim(char *str)
+{
+    char *end;
+    while (isspace((unsigned char) *str))
+        str++;
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char) end[-1]))
+        end--;
+    *end = '\0';
+    return str;
+}
+
+/* Join a file name to the folder of the parameter file, unless it is absolute. */
+static void joinPath(char *path, const char *folder, const char *fileName)
+{
+    if (fileName[0] == '/' || fileName[0] == '\\' || (fileName[0] != '\0' && fileName[1] == ':') || folder[0] == '\0')
+        snprintf(path, MAX_PATH_LENGTH, "%s", fileName);
+    else
+        snprintf(path, MAX_PATH_LENGTH, "%s/%s", folder, fileName);
+}
+
+/* Read the parameter file. Returns the number of bores or -1 on error. */
+static int readParameterFile(const char *fileName, boreSettings **bores)
+{
+    FILE *fid;
+    char line[MAX_LINE_LENGTH], folder[MAX_PATH_LENGTH], *key, *value, *name, *token, *endPtr, *cursor;
+    int nBores = 0, capacity = 0, lineNum = 0, i, isValid;
+    double x;
+    boreSettings *bore = NULL;
+    componentSettings *component;
+
+    fid = fopen(fileName, "r");
+    if (fid == NULL) {
+        fprintf(stderr, "The parameter file could not be opened: %s\n", fileName);
+        return -1;
+    }
+
+    snprintf(folder, MAX_PATH_LENGTH, "%s", fileName);
+    endPtr = strrchr(folder, '/');
+    if (endPtr == NULL)
+        endPtr = strrchr(folder, '\\');
+    if (endPtr != NULL)
+        *endPtr = '\0';
+    else
+        folder[0] = '\0';
+
+    *bores = NULL;
+    while (fgets(line, sizeof(line), fid) != NULL) {
+        lineNum++;
+        key = trim(line);
+        if (key[0] == '\0' || key[0] == '#' || key[0] == ';')
+            continue;
+
+        /* Start of a new bore */
+        if (key[0] == '[') {
+            if (strncmp(key, "[bore", 5) != 0 || key[strlen(key)-1] != ']') {
+                fprintf(stderr, "Line %d: expected [bore ID].\n", lineNum);
+                goto error;
+            }
+            if (nBores == capacity) {
+                capacity = capacity == 0 ? 64 : 2 * capacity;
+                *bores = (boreSettings *) realloc(*bores, capacity * sizeof(boreSettings));
+            }
+            bore = *bores + nBores;
+            nBores++;
+            memset(bore, 0, sizeof(boreSettings));
+            key[strlen(key)-1] = '\0';
+            snprintf(bore->boreID, MAX_MESSAGE_LENGTH, "%s", trim(key + 5));
+            bore->SMSC = NAN;
+            bore->k_sat = NAN;
+            bore->alpha = NAN;
+            bore->beta = NAN;
+            bore->gamma = NAN;
+            bore->S_initialfrac = 1.0;
+            bore->k_infilt = INFINITY;
+            bore->interflow_frac = 0.0;
+            bore->eps = 0.0;
+            bore->DDF = NAN;
+            bore->melt_threshold = NAN;
+            bore->noise_alpha = NAN;
+            bore->d = NAN;
+            bore->sigma_n = NAN;
+            continue;
+        }
+
+        value = strchr(key, '=');
+        if (bore == NULL || value == NULL) {
+            fprintf(stderr, "Line %d: expected [bore ID] or key = value.\n", lineNum);
+            goto error;
+        }
+        *value = '\0';
+        key = trim(key);
+        value = trim(value + 1);
+
+        if (strcmp(key, "forcing") == 0)
+            snprintf(bore->forcingFile, MAX_PATH_LENGTH, "%s", value);
+        else if (strcmp(key, "head") == 0)
+            snprintf(bore->headFile, MAX_PATH_LENGTH, "%s", value);
+        else if (strcmp(key, "store") == 0)
+            joinPath(bore->storeFile, folder, value);
+        else if (strcmp(key, "output") == 0)
+            joinPath(bore->outputFile, folder, value);
+        else if (strcmp(key, "noise_alpha") == 0 || strcmp(key, "d") == 0 || strcmp(key, "sigma_n") == 0) {
+            x = strtod(value, &endPtr);
+            if (endPtr == value) {
+                fprintf(stderr, "Line %d: %s must be a number.\n", lineNum, key);
+                goto error;
+            }
+            if (strcmp(key, "noise_alpha") == 0)
+                bore->noise_alpha = x;
+            else if (strcmp(key, "d") == 0)
+                bore->d = x;
+            else
+                bore->sigma_n = x;
+        }
+        else if (strcmp(key, "soil") == 0) {
+            cursor = value;
+            name = nextToken(&cursor, " \t,");
+            while (name != NULL) {
+                token = nextToken(&cursor, " \t,");
+                x = token == NULL ? NAN : strtod(token, &endPtr);
+                if (token == NULL || endPtr == token) {
+                    fprintf(stderr, "Line %d: the soil parameter %s has no value.\n", lineNum, name);
+                    goto error;
+                }
+                if (strcmp(name, "SMSC") == 0) bore->SMSC = x;
+                else if (strcmp(name, "S_initialfrac") == 0) bore->S_initialfrac = x;
+                else if (strcmp(name, "k_infilt") == 0) bore->k_infilt = x;
+                else if (strcmp(name, "k_sat") == 0) bore->k_sat = x;
+                else if (strcmp(name, "interflow_frac") == 0) bore->interflow_frac = x;
+                else if (strcmp(name, "alpha") == 0) bore->alpha = x;
+                else if (strcmp(name, "beta") == 0) bore->beta = x;
+                else if (strcmp(name, "gamma") == 0) bore->gamma = x;
+                else if (strcmp(name, "eps") == 0) bore->eps = x;
+                else if (strcmp(name, "DDF") == 0) bore->DDF = x;
+                else if (strcmp(name, "melt_threshold") == 0) bore->melt_threshold = x;
+                else {
+                    fprintf(stderr, "Line %d: unknown soil parameter %s.\n", lineNum, name);
+                    goto error;
+                }
+                name = nextToken(&cursor, " \t,");
+            }
+        }
+        else if (strcmp(key, "component") == 0) {
+            if (bore->nComponents == MAX_COMPONENTS) {
+                fprintf(stderr, "Line %d: a maximum of %d components are supported.\n", lineNum, MAX_COMPONENTS);
+                goto error;
+            }
+            component = bore->component + bore->nComponents;
+            cursor = value;
+            name = nextToken(&cursor, " \t,");
+            component->forcing = -1;
+            for (i = 0; name != NULL && i < nForcingNames; i++)
+                if (strcmp(name, forcingNames[i]) == 0)
+                    component->forcing = i;
+            token = nextToken(&cursor, " \t,");
+            isValid = component->forcing >= 0 && token != NULL;
+            if (isValid) {
+                component->isNegative = strcmp(token, "PearsonsNegative") == 0;
+                isValid = component->isNegative || strcmp(token, "Pearsons") == 0;
+            }
+            for (i = 0; i < 3 && isValid; i++) {
+                token = nextToken(&cursor, " \t,");
+                x = token == NULL ? NAN : strtod(token, &endPtr);
+                isValid = token != NULL && endPtr != token;
+                if (i == 0) component->A = x;
+                else if (i == 1) component->b = x;
+                else component->n = x;
+            }
+            if (!isValid) {
+                fprintf(stderr, "Line %d: expected component = forcing Pearsons|PearsonsNegative A b n.\n", lineNum);
+                goto error;
+            }
+            bore->nComponents++;
+        }
+        else {
+            fprintf(stderr, "Line %d: unknown key %s.\n", lineNum, key);
+            goto error;
+        }
+    }
+    fclose(fid);
+
+    /* Check the required settings of each bore. Without a store, the forcing
+     * and head are file names. */
+    for (i = 0; i < nBores; i++) {
+        bore = *bores + i;
+        if (bore->storeFile[0] == '\0') {
+            snprintf(line, MAX_PATH_LENGTH, "%s", bore->forcingFile);
+            if (line[0] != '\0')
+                joinPath(bore->forcingFile, folder, line);
+            snprintf(line, MAX_PATH_LENGTH, "%s", bore->headFile);
+            if (line[0] != '\0')
+                joinPath(bore->headFile, folder, line);
+        }
+        if (bore->forcingFile[0] == '\0' || bore->outputFile[0] == '\0' || bore->nComponents == 0
+        || isnan(bore->SMSC) || isnan(bore->k_sat) || isnan(bore->alpha) || isnan(bore->beta) || isnan(bore->gamma)
+        || (isnan(bore->noise_alpha) && bore->headFile[0] != '\0')) {
+            fprintf(stderr, "Bore %s: forcing, output, at least one component, noise_alpha (if head is input) and "
+                    "the soil parameters SMSC, k_sat, alpha, beta and gamma are required.\n", bore->boreID);
+            free(*bores);
+            *bores = NULL;
+            return -1;
+        }
+    }
+    return nBores;
+
+error:
+    fclose(fid);
+    free(*bores);
+    *bores = NULL;
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *parameterFile = NULL, *summaryFile = NULL;
+    boreSettings *bores = NULL;
+    boreResult *results;
+    tsStore *stores;
+    int i, j, nBores, nStores = 0, nFailed = 0;
+    double t0;
+    char message[TSSTORE_MESSAGE_LENGTH];
+    FILE *fid = stdout;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+#ifdef _OPENMP
+            omp_set_num_threads(atoi(argv[i+1]));
+#endif
+            i++;
+        }
+        else if (strcmp(argv[i], "--summary") == 0 && i + 1 < argc)
+            summaryFile = argv[++i];
+        else if (argv[i][0] != '-' && parameterFile == NULL)
+            parameterFile = argv[i];
+        else {
+            fprintf(stderr, "Usage: %s parameterFile [--threads n] [--summary file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (parameterFile == NULL) {
+        fprintf(stderr, "Usage: %s parameterFile [--threads n] [--summary file]\n", argv[0]);
+        return 2;
+    }
+
+    t0 = getTime();
+    nBores = readParameterFile(parameterFile, &bores);
+    if (nBores < 0)
+        return 2;
+    results = (boreResult *) calloc(nBores > 0 ? nBores : 1, sizeof(boreResult));
+
+    /* Map each store once. It is then shared, read-only, by all threads. */
+    stores = (tsStore *) calloc(nBores > 0 ? nBores : 1, sizeof(tsStore));
+    for (i = 0; i < nBores; i++) {
+        bores[i].storeIndex = -1;
+        if (bores[i].storeFile[0] == '\0')
+            continue;
+        for (j = 0; j < i && bores[i].storeIndex < 0; j++)
+            if (bores[j].storeIndex >= 0 && strcmp(bores[j].storeFile, bores[i].storeFile) == 0)
+                bores[i].storeIndex = bores[j].storeIndex;
+        if (bores[i].storeIndex < 0) {
+            if (!tsStore_open(bores[i].storeFile, stores + nStores, message)) {
+                fprintf(stderr, "%s\n", message);
+                return 2;
+            }
+            bores[i].storeIndex = nStores;
+            nStores++;
+        }
+    }
+
+    /* Simulate the bores. The run time of each bore varies with the record
+     * length and so the bores are dynamically scheduled. */
+    #pragma omp parallel for schedule(dynamic,1)
+    for (i = 0; i < nBores; i++)
+        simulateBore(bores + i, stores, results + i);
+
+    if (summaryFile != NULL) {
+        fid = fopen(summaryFile, "w");
+        if (fid == NULL) {
+            fprintf(stderr, "The summary file could not be created: %s\n", summaryFile);
+            return 2;
+        }
+    }
+    fprintf(fid, "bore_ID,status,nDays,nTimePoints,d,sigma_n,objFn,runTime_ms,message\n");
+    for (i = 0; i < nBores; i++) {
+        fprintf(fid, "%s,%s,%d,%d,%.6f,%.6f,%.6g,%.3f,%s\n", bores[i].boreID, results[i].status ? "ok" : "error",
+                results[i].nDays, results[i].nTimePoints, results[i].d, results[i].sigma_n, results[i].objFn,
+                1000.0 * results[i].runTime, results[i].message);
+        nFailed += !results[i].status;
+    }
+    if (fid != stdout)
+        fclose(fid);
+    fprintf(stderr, "Simulated %d bores (%d failed) in %.3f s.\n", nBores, nFailed, getTime() - t0);
+
+    for (i = 0; i < nStores; i++)
+        tsStore_close(stores + i);
+    free(stores);
+    free(results);
+    free(bores);
+    return nFailed > 0;
+}
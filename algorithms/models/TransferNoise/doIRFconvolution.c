@@ -34,8 +34,97 @@
 
 
 #include "math.h"
+#ifdef MATLAB_MEX_FILE
 #include "mex.h"
+#include "../../kernelStats.h"
+#endif
 #include "time.h"
+#include "string.h"
+#include "stdlib.h"
+#include "../../hydroSightKernels.h"
+
+/* Streaming (tiled) convolution settings. Output time points are processed
+ * in tiles of at most MAX_TILE_SIZE points and, within each tile, the
+ * forcing record is swept in blocks of FORCING_BLOCK_SIZE days. Only the
+ * current forcing block and the matching window of theta are therefore
+ * touched by a tile, keeping the working set within cache for very long or
+ * sub-daily records. */
+#define DEFAULT_TILE_SIZE 64
+#define MAX_TILE_SIZE 512
+#define FORCING_BLOCK_SIZE 1024
+#define MIN(x,y) (x <= y ? x : y)
+#define MAX(x,y) (x <= y ? y : x)
+
+/* Recursive convolution settings (see convolution_recursive()). The maximum
+ * number of exponential terms, the maximum integer power of t within a term,
+ * the maximum total number of filter states and the maximum difference
+ * between theta and the terms (relative to the maximum of theta). */
+#define MAX_RECURSIVE_TERMS 8
+#define MAX_RECURSIVE_ORDER 16
+#define MAX_RECURSIVE_STATES 64
+#define RECURSIVE_TOLERANCE 1e-8
+
+/* Convolution cache settings. The cache holds the convolution results of
+ * individual model components so that, during calibration, components whose
+ * response function parameters and forcing are unchanged are not recomputed.
+ * Entries are keyed on a hash of the cache key (ie the component parameters), 
+ * the forcing and the output time point indexes. When full, the least 
+ * recently used entry is replaced. */
+#define DEFAULT_CACHE_CAPACITY 64
+
+/* The MATLAB gateway, the input handling and the cache are only compiled for
+ * the MEX. The convolution kernels below have no dependency on MATLAB and so
+ * can also be linked into the native benchmark (see 
+ * testing/benchmark/benchmarkKernels.c). */
+#ifdef MATLAB_MEX_FILE
+typedef struct {
+    unsigned long long hash;
+    unsigned long long checksum;
+    int nKey;
+    double *key;
+    int nForcing;
+    int nIndex;
+    double *result;
+    unsigned long long lastUsed;
+} cacheEntry;
+
+static cacheEntry *cache = NULL;
+static int cacheCapacity = DEFAULT_CACHE_CAPACITY;
+static int nCacheEntries = 0;
+static unsigned long long cacheClock = 0, cacheHits = 0, cacheMisses = 0;
+
+/* Run time statistics (see kernelStats.h). In addition to the common 
+ * statistics, the number of calls using the streaming convolution, deriving
+ * the Jacobian and using the recursive convolution are counted. */
+static kernelStats stats = {0, 0.0, 0.0, 0.0, 0.0};
+static double statsStreamingCalls = 0.0, statsJacobianCalls = 0.0, statsRecursiveCalls = 0.0;
+
+void convolution(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void recursiveCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void cacheCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+/* Gateway function. If the first input is a string then a statistics command
+ * (see statsCommand()), the recursive convolution (see recursiveCommand()) 
+ * or a cache command (see cacheCommand()) is undertaken. Else, the 
+ * convolution is undertaken. */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
+{
+    char command[16];
+    
+    if (nrhs > 0 && mxIsChar(prhs[0])) {
+        mxGetString(prhs[0], command, sizeof(command));
+        if (strncmp(command, "stats", 5) == 0)
+            statsCommand(nlhs, plhs, nrhs, prhs);
+        else if (strcmp(command, "recursive") == 0)
+            recursiveCommand(nlhs, plhs, nrhs, prhs);
+        else
+            cacheCommand(nlhs, plhs, nrhs, prhs);
+    }
+    else
+        convolution(nlhs, plhs, nrhs, prhs);
+}
+#endif
 #if defined(__INTEL_COMPILER) && defined(__INTEL_OFFLOAD)
     #include "offload.h"
     #define ALLOC alloc_if(1)
@@ -44,7 +133,8 @@
     #define REUSE alloc_if(0)    
 #endif
 
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
+#ifdef MATLAB_MEX_FILE
+void convolution(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) 
 {    
     /* Declare constants for matrix size and index counter */
     const int nTheta  = (int)mxGetM(prhs[0] );
@@ -77,6 +167,34 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
      * forcing over the first day is adopted. */
     const double inteTheta_0to1 = mxGetScalar(prhs[5]);    
     
+    /* Optional inputs for the streaming convolution. If the integral of 
+     * theta from tor_end to inf. (one value per output time point) and the 
+     * mean forcing are input, then the upper tail correction is added 
+     * within the kernel and the output is written tile by tile. The
+     * optional 9th input is the number of output time points per tile. */
+    const int doStreaming = nrhs >= 8;
+    const double *intTheta_upperTail = doStreaming ? mxGetPr( prhs[6] ) : NULL;
+    const double forcingMean = doStreaming ? mxGetScalar(prhs[7]) : 0.0;
+    const int tileSize = nrhs >= 9 ? (int)mxGetScalar(prhs[8]) : DEFAULT_TILE_SIZE;
+    
+    /* Optional inputs for the sensitivity of the streaming convolution to 
+     * the response function parameters (see convolution_streaming()):
+     * dtheta/dp (nTheta x nParams), the derivative of the integral of theta 
+     * from 0 to 1 (nParams) and the derivative of the upper tail integral 
+     * (nParams x nIndex). The sensitivities are returned as the second output. */
+    const int doJacobian = doStreaming && nrhs >= 12;
+    const int nParams = doJacobian ? (int)mxGetN(prhs[9]) : 0;
+    const double *dtheta = doJacobian ? mxGetPr( prhs[9] ) : NULL;
+    const double *dIntTheta_0to1 = doJacobian ? mxGetPr( prhs[10] ) : NULL;
+    const double *dIntTheta_upperTail = doJacobian ? mxGetPr( prhs[11] ) : NULL;
+    double *jacobian = NULL;
+    
+    /* Declare run time statistics variables. */
+    double tStart = 0.0, statsWindow;
+    
+    /* Declare names of fields for the kernel information output. */
+    const char *infoFieldNames[] = {"streaming", "maxTileSize", "cache", "jacobian", "recursive"};    
+    
 #if defined(__INTEL_COMPILER) && defined(__INTEL_OFFLOAD)
    /* Delacre offloaded functions */
    __declspec(target(mic:coprocessorNum))  double trapazoidal(const int theta_index_start, const int theta_index_end, const double *dx, const double *dy, const double *intTheta);
@@ -86,6 +204,11 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     double trapazoidal(const int theta_index_start, const int theta_index_end, const double *dx, const double *dy, const double *intTheta);
     double Simpsons_ExtendedRule(const int theta_index_start, const int theta_index_end, const double *dx, const double *dy, const double *intTheta);      
 #endif
+    void convolution_streaming(const double *theta, const double *theta_indexes_start, const int nIndex, const int theta_index_end, 
+            const double *forcing, const int isForcingAnIntegral, const double intTheta_0to1, const double *intTheta_upperTail, 
+            const double forcingMean, const int tileSize, double *result, 
+            const int nTheta, const int nParams, const double *dtheta, const double *dIntTheta_0to1, const double *dIntTheta_upperTail, 
+            double *jacobian);
     
     /* Declare output vectors for results*/
     plhs[0] = mxCreateDoubleMatrix(1,nIndex,mxREAL);
@@ -338,11 +461,44 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
    }
 #else
 
+    /* Return the kernel information if the inputs are empty. */
     if (nTheta==0 && nIndex==0 && nForcing ==0) {    
+      if (nlhs > 1) {
+         plhs[1] = mxCreateStructMatrix(1, 1, 5, infoFieldNames);
+         mxSetField(plhs[1], 0, "streaming", mxCreateLogicalScalar(1));
+         mxSetField(plhs[1], 0, "maxTileSize", mxCreateDoubleScalar(MAX_TILE_SIZE));
+         mxSetField(plhs[1], 0, "cache", mxCreateLogicalScalar(1));
+         mxSetField(plhs[1], 0, "jacobian", mxCreateLogicalScalar(1));
+         mxSetField(plhs[1], 0, "recursive", mxCreateLogicalScalar(1));
+      }
       return;
     }
 
-    if (isForcingAnIntegral==0 ) {      
+    if (stats.enabled)
+        tStart = kernelStats_clock();
+
+    if (doStreaming) {
+        if ((int)mxGetNumberOfElements(prhs[6]) != nIndex)
+            mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                    "The upper tail integral of theta must have one value per output time point.");
+        
+        if (doJacobian) {
+            if ((int)mxGetM(prhs[9]) != nTheta || (int)mxGetNumberOfElements(prhs[10]) != nParams 
+            || (int)mxGetNumberOfElements(prhs[11]) != nParams*nIndex)
+                mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                        "dtheta/dp must be nTheta x nParams, the lower tail derivatives nParams x 1 and the upper tail derivatives nParams x nIndex.");
+            if (nParams + 1 > MAX_TILE_SIZE)
+                mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                        "dtheta/dp must have fewer than %d columns.", MAX_TILE_SIZE);
+            plhs[1] = mxCreateDoubleMatrix(nIndex,nParams,mxREAL);
+            jacobian = mxGetPr(plhs[1]);
+        }
+        
+        convolution_streaming(theta, theta_indexes_start, nIndex, theta_indexes_end, forcing, isForcingAnIntegral, 
+                inteTheta_0to1, intTheta_upperTail, forcingMean, tileSize, result, 
+                nTheta, nParams, dtheta, dIntTheta_0to1, dIntTheta_upperTail, jacobian);
+    }
+    else if (isForcingAnIntegral==0 ) {      
         /*for(int iIndex=0;iIndex<nIndex; iIndex++) */
         for(iIndex=nIndex; iIndex--;) 
             result[iIndex] = Simpsons_ExtendedRule((int)theta_indexes_start[iIndex], theta_indexes_end, theta + (int)theta_indexes_start[iIndex]- 1, forcing, &inteTheta_0to1);
@@ -353,10 +509,25 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             result[iIndex] = trapazoidal((int)theta_indexes_start[iIndex], theta_indexes_end, theta + (int)theta_indexes_start[iIndex]- 1, forcing, &inteTheta_0to1);        
                 
     }
+    
+    /* Update the statistics. The bytes touched are estimated as the theta, 
+     * forcing and dtheta/dp within the convolution window of each output 
+     * time point, plus the outputs. */
+    if (stats.enabled) {
+        statsWindow = 0.0;
+        for(iIndex=0;iIndex<nIndex; iIndex++) 
+            statsWindow += theta_indexes_end - theta_indexes_start[iIndex];
+        kernelStats_record(&stats, tStart, nIndex, sizeof(double) * ((2.0 + nParams) * statsWindow + (1.0 + nParams) * nIndex));
+        if (doStreaming)
+            statsStreamingCalls++;
+        if (doJacobian)
+            statsJacobianCalls++;
+    }
 #endif       
 
 
 }
+#endif
 
 
 /* Integration using the Trapazoidal rule under the assumption that the
@@ -408,3 +579,599 @@ double Simpsons_ExtendedRule(const int theta_index_start, const int theta_index_
     
     return ret_val;
 }
+
+/* Streaming convolution of theta with the forcing for all output time points.
+ *
+ * The result for each output time point is identical to that from 
+ * Simpsons_ExtendedRule() or trapazoidal() plus the upper tail correction 
+ * (ie intTheta_upperTail * forcingMean), but the output time points are 
+ * processed in tiles and the forcing is swept in blocks that are shared by all
+ * points within the tile. The summation order for each output point is 
+ * unchanged and so the results are bitwise identical to the non-tiled 
+ * kernels. The only exception is that theta and forcing values preceding the
+ * start of the input arrays are taken as zero (the trapazoidal kernel reads one
+ * element past the start of each array for the earliest time point).
+ *
+ * If nParams>0, the sensitivity of the result to each of the nParams response
+ * function parameters is also derived. Because the convolution is linear in 
+ * theta, the sensitivity is the convolution of dtheta/dp (nTheta x nParams)
+ * plus the sensitivities of the lower tail (dIntTheta_0to1, nParams) and upper
+ * tail (dIntTheta_upperTail, nParams x nIndex) integrals. Each forcing value is
+ * loaded once for theta and all dtheta/dp columns. The result is written to 
+ * jacobian (nIndex x nParams). nParams must be less than MAX_TILE_SIZE.
+ *
+ * No memory is allocated. The working memory is a stack array of the partial
+ * sums for the tile and the results are written directly into the caller 
+ * provided output vectors. */
+void convolution_streaming(const double *theta, const double *theta_indexes_start, const int nIndex, const int theta_index_end, 
+        const double *forcing, const int isForcingAnIntegral, const double intTheta_0to1, const double *intTheta_upperTail, 
+        const double forcingMean, const int tileSize, double *result, 
+        const int nTheta, const int nParams, const double *dtheta, const double *dIntTheta_0to1, const double *dIntTheta_upperTail, 
+        double *jacobian)
+{
+    int iTile, iTileEnd, nTile, iIndex, iOut, iStream, k, kBlock, kStart, kEnd, kMax, start, endIndex, isLastBlock;
+    double acc[MAX_TILE_SIZE], f, intTheta, upperTail, *a;
+    const double *dx, *theta_s;
+    const int nStreams = 1 + nParams;
+    const int tile = MAX(1, (tileSize < 1 ? DEFAULT_TILE_SIZE : MIN(tileSize, MAX_TILE_SIZE)) / nStreams);
+
+    for (iTile = 0; iTile < nIndex; iTile += tile) {
+        iTileEnd = MIN(iTile + tile, nIndex);
+        nTile = iTileEnd - iTile;
+
+        /* Initialise the partial sums with the leading terms and get the 
+         * range of forcing indexes used by the tile. Stream 0 is theta and 
+         * stream i>0 is dtheta/dp for parameter i. */
+        kMax = 0;
+        for (iOut = 0; iOut < nTile; iOut++) {
+            start = (int)theta_indexes_start[iTile + iOut];
+            endIndex = theta_index_end - start - 1;
+            for (iStream = 0; iStream < nStreams; iStream++) {
+                theta_s = iStream == 0 ? theta : dtheta + (iStream-1)*nTheta;
+                intTheta = iStream == 0 ? intTheta_0to1 : dIntTheta_0to1[iStream-1];
+                dx = theta_s + start - 1;
+                if (isForcingAnIntegral==0)
+                    acc[iOut*nStreams + iStream] = 3./8. * dx[endIndex-1] * forcing[endIndex-1] + 
+                                                   7./6. * dx[endIndex-2] * forcing[endIndex-2] + 
+                                                   23./24. * dx[endIndex-3] * forcing[endIndex-3];
+                else
+                    acc[iOut*nStreams + iStream] = 2 * intTheta * forcing[endIndex];
+            }
+            if (isForcingAnIntegral==0)
+                kMax = MAX(kMax, endIndex - 3);
+            else
+                kMax = MAX(kMax, endIndex);
+        }
+
+        /* Sweep the forcing in blocks. Simpson's internal points are summed 
+         * in ascending order and the trapazoidal points in descending order, 
+         * as per the non-tiled kernels. */
+        if (isForcingAnIntegral==0) {
+            for (kBlock = 3; kBlock < kMax; kBlock += FORCING_BLOCK_SIZE) {
+                for (iOut = 0; iOut < nTile; iOut++) {
+                    start = (int)theta_indexes_start[iTile + iOut];
+                    endIndex = theta_index_end - start - 1;
+                    kStart = kBlock;
+                    kEnd = MIN(kBlock + FORCING_BLOCK_SIZE, endIndex - 3);
+                    a = acc + iOut*nStreams;
+                    if (nStreams == 1) {
+                        dx = theta + start - 1;
+                        for (k = kStart; k < kEnd; k++)
+                            a[0] += dx[k] * forcing[k];
+                    }
+                    else {
+                        for (k = kStart; k < kEnd; k++) {
+                            f = forcing[k];
+                            a[0] += theta[start - 1 + k] * f;
+                            for (iStream = 1; iStream < nStreams; iStream++)
+                                a[iStream] += dtheta[(iStream-1)*nTheta + start - 1 + k] * f;
+                        }
+                    }
+                }
+            }
+        }
+        else {
+            for (kBlock = kMax; kBlock > 0; kBlock -= FORCING_BLOCK_SIZE) {
+                for (iOut = 0; iOut < nTile; iOut++) {
+                    start = (int)theta_indexes_start[iTile + iOut];
+                    endIndex = theta_index_end - start - 1;
+                    kStart = MIN(kBlock, endIndex) - 1;
+                    kEnd = MAX(kBlock - FORCING_BLOCK_SIZE, 0);
+                    isLastBlock = kEnd == 0;
+                    a = acc + iOut*nStreams;
+                    
+                    /* Theta prior to the first element is taken as zero. */
+                    if (isLastBlock && start < 2)
+                        kEnd = 1;                    
+                    for (iStream = 0; iStream < nStreams; iStream++) {
+                        theta_s = iStream == 0 ? theta : dtheta + (iStream-1)*nTheta;
+                        dx = theta_s + start - 1;
+                        for (k = kStart; k >= kEnd; k--)
+                            a[iStream] += (dx[k] + dx[k-1]) * forcing[k];
+                        if (isLastBlock && start < 2 && endIndex > 0)
+                            a[iStream] += dx[0] * forcing[0];
+                    }
+                }
+            }
+        }
+
+        /* Add the trailing terms, the high precision estimate over the first
+         * time step and the upper tail correction. */
+        for (iOut = 0; iOut < nTile; iOut++) {
+            iIndex = iTile + iOut;
+            start = (int)theta_indexes_start[iIndex];
+            endIndex = theta_index_end - start - 1;
+            for (iStream = 0; iStream < nStreams; iStream++) {
+                theta_s = iStream == 0 ? theta : dtheta + (iStream-1)*nTheta;
+                intTheta = iStream == 0 ? intTheta_0to1 : dIntTheta_0to1[iStream-1];
+                upperTail = iStream == 0 ? intTheta_upperTail[iIndex] : dIntTheta_upperTail[iIndex*nParams + iStream-1];
+                dx = theta_s + start - 1;
+                a = acc + iOut*nStreams + iStream;
+                if (isForcingAnIntegral==0) {
+                    *a += 23./24. * dx[2] * forcing[2] + 
+                          7./6. * dx[1] * forcing[1] + 
+                          3./8. * dx[0] * forcing[0];
+                    *a +=  intTheta * 0.5 * (forcing[endIndex] + forcing[endIndex-1]);
+                    *a = *a + upperTail * forcingMean;
+                }
+                else
+                    *a = 0.5 * *a + upperTail * forcingMean;
+
+                if (iStream == 0)
+                    result[iIndex] = *a;
+                else
+                    jacobian[(iStream-1)*nIndex + iIndex] = *a;
+            }
+        }
+    }
+} /* convolution_streaming */
+
+/* Theta at time t from the terms of convolution_recursive(). */
+double thetaTerms(const int nTerms, const double *terms, const int t)
+{
+    int iTerm;
+    double result = 0.0;
+    for (iTerm = 0; iTerm < nTerms; iTerm++)
+        result += terms[iTerm] * pow((double)t, terms[2*nTerms + iTerm]) * exp(-terms[nTerms + iTerm] * t);
+    return result;
+} /* thetaTerms */
+
+/* Recursive convolution of theta with the forcing for all output time points.
+ *
+ * If theta is a sum of terms c * t^m * exp(-a * t), with m a small integer and 
+ * a>=0 (eg Pearson's type III with an integer shape parameter), then the sum 
+ * of theta(i) * forcing(J-i) over the lags i=1 to J can be derived for every 
+ * forcing day J with a recursive (IIR) filter. The cost is then proportional 
+ * to the number of forcing days and is independent of tor. For each term, 
+ * t^m is expanded as the sum over k=0..m of W(m,k) * C(t,k), where C is the 
+ * binomial coefficient and W(m,k) = k! times the Stirling number of the 
+ * second kind (all W are >=0), and each state 
+ *   y_k(J) = sum_i C(i,k) * r^i * forcing(J-i), where r = exp(-a), 
+ * is updated by y_k(J) = r * (y_k(J-1) + y_(k-1)(J-1)) + forcing(J) (k=0 only).
+ *
+ * The end corrections of Simpson's composite rule, the daily integral 
+ * (trapazoidal) weights, the high precision estimate over the first time step
+ * and the upper tail correction are then applied as per convolution_streaming() 
+ * and so the results are identical to it to within rounding.
+ *
+ * terms is nTerms x 3 (column major) of c, a and m. The terms are checked 
+ * against theta (ie all nTheta values) and 0 is returned, without a result, if
+ * they cannot be used (eg m is not an integer, a<0 or the terms differ from 
+ * theta by more than RECURSIVE_TOLERANCE). The caller should then use 
+ * convolution_streaming(). Else 1 is returned. */
+int convolution_recursive(const int nTerms, const double *terms, const double *theta, const int nTheta,
+        const double *theta_indexes_start, const int nIndex, const int theta_index_end, 
+        const double *forcing, const int nForcing, const int isForcingAnIntegral, const double intTheta_0to1, 
+        const double *intTheta_upperTail, const double forcingMean, double *result)
+{
+    int iTerm, iIndex, i, k, m, J, maxJ, nStates, start, order[MAX_RECURSIVE_TERMS];
+    double W[MAX_RECURSIVE_ORDER+1][MAX_RECURSIVE_ORDER+1], weights[MAX_RECURSIVE_STATES], y[MAX_RECURSIVE_STATES];
+    double r[MAX_RECURSIVE_TERMS], c, a, err, maxErr, maxTheta, sum, sum_shifted, *S, *S_shifted, *w, *yTerm;
+    
+    /* Check the terms can be represented by the filter. */
+    if (nTerms < 1 || nTerms > MAX_RECURSIVE_TERMS || nIndex < 1)
+        return 0;
+    nStates = 0;
+    for (iTerm = 0; iTerm < nTerms; iTerm++) {
+        c = terms[iTerm];
+        a = terms[nTerms + iTerm];
+        if (!isfinite(c) || !isfinite(a) || a < 0.0 || terms[2*nTerms + iTerm] != floor(terms[2*nTerms + iTerm])
+        || terms[2*nTerms + iTerm] < 0.0 || terms[2*nTerms + iTerm] > MAX_RECURSIVE_ORDER)
+            return 0;
+        order[iTerm] = (int)terms[2*nTerms + iTerm];
+        r[iTerm] = exp(-a);
+        nStates += order[iTerm] + 1;
+    }
+    if (nStates > MAX_RECURSIVE_STATES)
+        return 0;
+    
+    /* Get the last forcing day of the output time points. */
+    maxJ = -1;
+    for (iIndex = 0; iIndex < nIndex; iIndex++) {
+        J = theta_index_end - (int)theta_indexes_start[iIndex] - 1;
+        if (J < 0 || J >= nForcing || theta_index_end - 2 - J < 0)
+            return 0;
+        maxJ = MAX(maxJ, J);
+    }
+    
+    /* Check the terms reproduce theta. Theta is for tor = theta_index_end-2 
+     * to 0 and so theta at a lag (ie tor) of i is theta[theta_index_end-2-i]. */
+    maxErr = 0.0;
+    maxTheta = 0.0;
+    for (i = 1; i <= theta_index_end - 2; i++) {
+        if (theta_index_end - 2 - i >= nTheta)
+            continue;
+        err = fabs(thetaTerms(nTerms, terms, i) - theta[theta_index_end - 2 - i]);
+        if (!(err <= maxErr))
+            maxErr = err;
+        maxTheta = MAX(maxTheta, fabs(theta[theta_index_end - 2 - i]));
+    }
+    if (!(maxErr <= RECURSIVE_TOLERANCE * maxTheta))
+        return 0;
+    
+    /* Get the weight of each state. W(m,k) = k * (W(m-1,k) + W(m-1,k-1)). */
+    memset(W, 0, sizeof(W));
+    W[0][0] = 1.0;
+    for (m = 1; m <= MAX_RECURSIVE_ORDER; m++)
+        for (k = 1; k <= m; k++)
+            W[m][k] = k * (W[m-1][k] + W[m-1][k-1]);
+    w = weights;
+    for (iTerm = 0; iTerm < nTerms; iTerm++) {
+        for (k = 0; k <= order[iTerm]; k++)
+            w[k] = terms[iTerm] * W[order[iTerm]][k];
+        w += order[iTerm] + 1;
+    }
+    
+    /* Run the filter over the forcing. For each day J, S is the sum of 
+     * theta(i) * forcing(J-i) and S_shifted is the sum of theta(i+1) * forcing(J-i), 
+     * for i=1 to J. The latter is only required for the trapazoidal rule and, 
+     * as C(i+1,k) = C(i,k) + C(i,k-1), is derived from the same states. */
+    S = (double *)malloc(2 * (maxJ + 1) * sizeof(double));
+    if (S == NULL)
+        return 0;
+    S_shifted = S + maxJ + 1;
+    memset(y, 0, sizeof(y));
+    for (J = 0; J <= maxJ; J++) {
+        sum = 0.0;
+        sum_shifted = 0.0;
+        w = weights;
+        yTerm = y;
+        for (iTerm = 0; iTerm < nTerms; iTerm++) {
+            for (k = order[iTerm]; k > 0; k--)
+                yTerm[k] = r[iTerm] * (yTerm[k] + yTerm[k-1]);
+            yTerm[0] = r[iTerm] * yTerm[0];
+            for (k = order[iTerm]; k > 0; k--) {
+                sum += w[k] * yTerm[k];
+                sum_shifted += r[iTerm] * w[k] * (yTerm[k] + yTerm[k-1]);
+            }
+            sum += w[0] * yTerm[0];
+            sum_shifted += r[iTerm] * w[0] * yTerm[0];
+            yTerm[0] += forcing[J];
+            w += order[iTerm] + 1;
+            yTerm += order[iTerm] + 1;
+        }
+        S[J] = sum;
+        S_shifted[J] = sum_shifted;
+    }
+    
+    /* Apply the integration weights, the high precision estimate over the 
+     * first time step and the upper tail correction. */
+    for (iIndex = 0; iIndex < nIndex; iIndex++) {
+        start = (int)theta_indexes_start[iIndex];
+        J = theta_index_end - start - 1;
+        if (isForcingAnIntegral==0) {
+            /* Simpson's end corrections overlap for short records and so 
+             * the non-recursive kernel is used. */
+            if (J < 7)
+                result[iIndex] = Simpsons_ExtendedRule(start, theta_index_end, theta + start - 1, forcing, &intTheta_0to1);
+            else
+                result[iIndex] = S[J] 
+                        + (3./8. - 1.) * thetaTerms(nTerms, terms, 1) * forcing[J-1] 
+                        + (7./6. - 1.) * thetaTerms(nTerms, terms, 2) * forcing[J-2] 
+                        + (23./24. - 1.) * thetaTerms(nTerms, terms, 3) * forcing[J-3] 
+                        + (23./24. - 1.) * thetaTerms(nTerms, terms, J-2) * forcing[2] 
+                        + (7./6. - 1.) * thetaTerms(nTerms, terms, J-1) * forcing[1] 
+                        + (3./8. - 1.) * thetaTerms(nTerms, terms, J) * forcing[0] 
+                        + intTheta_0to1 * 0.5 * (forcing[J] + forcing[J-1]);
+            result[iIndex] = result[iIndex] + intTheta_upperTail[iIndex] * forcingMean;
+        }
+        else {
+            /* Theta prior to the first element is taken as zero (as per 
+             * convolution_streaming()). */
+            sum_shifted = S_shifted[J];
+            if (start < 2 && J > 0)
+                sum_shifted -= thetaTerms(nTerms, terms, J+1) * forcing[0];
+            result[iIndex] = 0.5 * (2 * intTheta_0to1 * forcing[J] + S[J] + sum_shifted) 
+                    + intTheta_upperTail[iIndex] * forcingMean;
+        }
+    }
+    
+    free(S);
+    return 1;
+} /* convolution_recursive */
+
+/* Hash of a vector of doubles. FNV-1a is applied to each 64 bit word. */
+unsigned long long hashDoubles(unsigned long long hash, const double *x, const int n)
+{
+    int i;
+    unsigned long long word;
+    for (i = 0; i < n; i++) {
+        memcpy(&word, x + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+} /* hashDoubles */
+
+/* Checksum of a vector of doubles, independent of hashDoubles(). Fletcher's
+ * checksum is applied to the 32 bit halves of each 64 bit word. The two
+ * running sums are returned in the upper and lower 32 bits. */
+unsigned long long checksumDoubles(unsigned long long checksum, const double *x, const int n)
+{
+    int i, j;
+    unsigned int halves[2];
+    unsigned long long sum1 = checksum & 0xFFFFFFFFULL, sum2 = checksum >> 32;
+    for (i = 0; i < n; i++) {
+        memcpy(halves, x + i, sizeof(halves));
+        for (j = 0; j < 2; j++) {
+            sum1 = (sum1 + halves[j]) % 0xFFFFFFFFULL;
+            sum2 = (sum2 + sum1) % 0xFFFFFFFFULL;
+        }
+    }
+    return (sum2 << 32) | sum1;
+} /* checksumDoubles */
+
+#ifdef MATLAB_MEX_FILE
+/* Free all entries within the cache. This is also registered with mexAtExit()
+ * so that the persistent memory is released when the MEX is cleared. */
+void freeCache(void)
+{
+    int i;
+    if (cache != NULL) {
+        for (i = 0; i < nCacheEntries; i++) {
+            mxFree(cache[i].key);
+            mxFree(cache[i].result);
+        }
+        mxFree(cache);
+    }
+    cache = NULL;
+    nCacheEntries = 0;
+} /* freeCache */
+
+/* Cache commands. The first input is the command name:
+ *   'cache_get', key, forcing, theta_indexes_start, theta_indexes_end
+ *       Returns the cached convolution (1 x nIndex) or [] if not cached.
+ *   'cache_put', key, forcing, theta_indexes_start, theta_indexes_end, result 
+ *       Adds the convolution result to the cache.
+ *   'cache_stats'
+ *       Returns a structure of the number of hits, misses, entries and the capacity.
+ *   'cache_capacity', n
+ *       Clears the cache and sets the maximum number of entries.
+ *   'cache_clear'
+ *       Clears the cache and resets the hit and miss counters.
+ */
+void cacheCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const char *statsFieldNames[] = {"hits", "misses", "entries", "capacity"};
+    char *command = mxArrayToString(prhs[0]);
+    unsigned long long hash, checksum;
+    int i, iEntry, nKey, nForcing, nIndex;
+    const double *key;
+
+    if (strcmp(command, "cache_get") == 0 || strcmp(command, "cache_put") == 0) {
+        if (nrhs < 5)
+            mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                    "The cache key, forcing, theta start indexes and theta end index must be input.");
+        
+        key = mxGetPr(prhs[1]);
+        nKey = (int)mxGetNumberOfElements(prhs[1]);
+        nForcing = (int)mxGetNumberOfElements(prhs[2]);
+        nIndex = (int)mxGetNumberOfElements(prhs[3]);
+        hash = hashDoubles(14695981039346656037ULL, key, nKey);
+        hash = hashDoubles(hash, mxGetPr(prhs[2]), nForcing);
+        hash = hashDoubles(hash, mxGetPr(prhs[3]), nIndex);
+        hash = hashDoubles(hash, mxGetPr(prhs[4]), 1);
+
+        /* The forcing and time points are not stored within the cache. To
+         * guard against a hash collision returning the convolution of other 
+         * inputs, a second independent checksum of them is also compared. */
+        checksum = checksumDoubles(1, mxGetPr(prhs[2]), nForcing);
+        checksum = checksumDoubles(checksum, mxGetPr(prhs[3]), nIndex);
+        checksum = checksumDoubles(checksum, mxGetPr(prhs[4]), 1);
+
+        /* Find the entry */
+        iEntry = -1;
+        for (i = 0; i < nCacheEntries; i++) {
+            if (cache[i].hash == hash && cache[i].checksum == checksum && cache[i].nKey == nKey 
+            && cache[i].nForcing == nForcing && cache[i].nIndex == nIndex
+            && memcmp(cache[i].key, key, nKey*sizeof(double)) == 0) {
+                iEntry = i;
+                break;
+            }
+        }
+
+        if (strcmp(command, "cache_get") == 0) {
+            if (iEntry >= 0) {
+                cacheHits++;
+                cache[iEntry].lastUsed = ++cacheClock;
+                plhs[0] = mxCreateDoubleMatrix(1, nIndex, mxREAL);
+                memcpy(mxGetPr(plhs[0]), cache[iEntry].result, nIndex*sizeof(double));
+            }
+            else {
+                cacheMisses++;
+                plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
+            }
+        }
+        else {
+            if (nrhs < 6 || (int)mxGetNumberOfElements(prhs[5]) != nIndex)
+                mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                        "The convolution result must have one value per output time point.");
+
+            if (cache == NULL) {
+                cache = (cacheEntry *)mxCalloc(cacheCapacity, sizeof(cacheEntry));
+                mexMakeMemoryPersistent(cache);
+                mexAtExit(freeCache);
+            }
+
+            /* If not already cached, replace the least recently used entry
+             * or, if the cache is not full, add a new entry. */
+            if (iEntry < 0) {
+                if (nCacheEntries < cacheCapacity) {
+                    iEntry = nCacheEntries;
+                    nCacheEntries++;
+                }
+                else {
+                    iEntry = 0;
+                    for (i = 1; i < nCacheEntries; i++)
+                        if (cache[i].lastUsed < cache[iEntry].lastUsed)
+                            iEntry = i;
+                    mxFree(cache[iEntry].key);
+                    mxFree(cache[iEntry].result);
+                }
+                cache[iEntry].hash = hash;
+                cache[iEntry].checksum = checksum;
+                cache[iEntry].nKey = nKey;
+                cache[iEntry].key = (double *)mxMalloc(MAX(nKey,1)*sizeof(double));
+                cache[iEntry].nForcing = nForcing;
+                cache[iEntry].nIndex = nIndex;
+                cache[iEntry].result = (double *)mxMalloc(MAX(nIndex,1)*sizeof(double));
+                mexMakeMemoryPersistent(cache[iEntry].key);
+                mexMakeMemoryPersistent(cache[iEntry].result);
+                memcpy(cache[iEntry].key, key, nKey*sizeof(double));
+            }
+            memcpy(cache[iEntry].result, mxGetPr(prhs[5]), nIndex*sizeof(double));
+            cache[iEntry].lastUsed = ++cacheClock;
+        }
+    }
+    else if (strcmp(command, "cache_stats") == 0) {
+        plhs[0] = mxCreateStructMatrix(1, 1, 4, statsFieldNames);
+        mxSetField(plhs[0], 0, "hits", mxCreateDoubleScalar((double)cacheHits));
+        mxSetField(plhs[0], 0, "misses", mxCreateDoubleScalar((double)cacheMisses));
+        mxSetField(plhs[0], 0, "entries", mxCreateDoubleScalar(nCacheEntries));
+        mxSetField(plhs[0], 0, "capacity", mxCreateDoubleScalar(cacheCapacity));
+    }
+    else if (strcmp(command, "cache_capacity") == 0) {
+        if (nrhs < 2 || mxGetScalar(prhs[1]) < 1)
+            mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                    "The cache capacity must be >=1.");
+        freeCache();
+        cacheCapacity = (int)mxGetScalar(prhs[1]);
+    }
+    else if (strcmp(command, "cache_clear") == 0) {
+        freeCache();
+        cacheHits = 0;
+        cacheMisses = 0;
+        cacheClock = 0;
+    }
+    else
+        mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                "Unknown command: %s", command);
+
+    mxFree(command);
+} /* cacheCommand */
+
+/* Recursive convolution command:
+ *   [result, isRecursive] = doIRFconvolution('recursive', terms, theta, theta_indexes_start, 
+ *           theta_indexes_end, forcing, isForcingAnIntegral, intTheta_0to1, intTheta_upperTail, forcingMean)
+ *
+ * The inputs following terms are as per the streaming convolution. terms is 
+ * an nTerms x 3 matrix of c, a and m such that theta(t) is the sum of 
+ * c * t^m * exp(-a * t) (see responseFunction_abstract.theta_recursiveTerms()).
+ * If the terms cannot be used by convolution_recursive() (eg they are empty 
+ * or do not reproduce theta) then the streaming convolution is undertaken.
+ * isRecursive is true if the recursive convolution was undertaken. */
+void recursiveCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    int nTheta, nIndex, nForcing, theta_indexes_end, isForcingAnIntegral, isRecursive, iIndex;
+    const double *terms, *theta, *theta_indexes_start, *forcing, *intTheta_upperTail;
+    double intTheta_0to1, forcingMean, *result, tStart = 0.0, statsWindow;
+    
+    if (nrhs < 10)
+        mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                "The terms, theta, theta start indexes, theta end index, forcing, integration flag, lower and upper tail integrals and mean forcing must be input.");
+    if (!mxIsEmpty(prhs[1]) && mxGetN(prhs[1]) != 3)
+        mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                "The terms must have three columns: the coefficient, the decay rate and the power of t.");
+    
+    terms = mxGetPr(prhs[1]);
+    theta = mxGetPr(prhs[2]);
+    nTheta = (int)mxGetM(prhs[2]);
+    theta_indexes_start = mxGetPr(prhs[3]);
+    nIndex = (int)mxGetNumberOfElements(prhs[3]);
+    theta_indexes_end = (int)mxGetScalar(prhs[4]) + 1;
+    forcing = mxGetPr(prhs[5]);
+    nForcing = (int)mxGetM(prhs[5]);
+    isForcingAnIntegral = (int)mxGetScalar(prhs[6]);
+    intTheta_0to1 = mxGetScalar(prhs[7]);
+    intTheta_upperTail = mxGetPr(prhs[8]);
+    forcingMean = mxGetScalar(prhs[9]);
+    if ((int)mxGetNumberOfElements(prhs[8]) != nIndex)
+        mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                "The upper tail integral of theta must have one value per output time point.");
+    
+    if (stats.enabled)
+        tStart = kernelStats_clock();
+    
+    plhs[0] = mxCreateDoubleMatrix(1,nIndex,mxREAL);
+    result = mxGetPr(plhs[0]);
+    isRecursive = convolution_recursive((int)mxGetM(prhs[1]), terms, theta, nTheta, theta_indexes_start, nIndex, 
+            theta_indexes_end, forcing, nForcing, isForcingAnIntegral, intTheta_0to1, intTheta_upperTail, forcingMean, result);
+    if (!isRecursive)
+        convolution_streaming(theta, theta_indexes_start, nIndex, theta_indexes_end, forcing, isForcingAnIntegral, 
+                intTheta_0to1, intTheta_upperTail, forcingMean, DEFAULT_TILE_SIZE, result, 
+                nTheta, 0, NULL, NULL, NULL, NULL);
+    if (nlhs > 1)
+        plhs[1] = mxCreateLogicalScalar(isRecursive);
+    
+    /* Update the statistics. The bytes touched by the recursive convolution
+     * are estimated as theta (when checking the terms), the forcing and the 
+     * outputs. */
+    if (stats.enabled) {
+        if (isRecursive) {
+            kernelStats_record(&stats, tStart, nIndex, sizeof(double) * ((double)nTheta + nForcing + nIndex));
+            statsRecursiveCalls++;
+        }
+        else {
+            statsWindow = 0.0;
+            for(iIndex=0;iIndex<nIndex; iIndex++) 
+                statsWindow += theta_indexes_end - theta_indexes_start[iIndex];
+            kernelStats_record(&stats, tStart, nIndex, sizeof(double) * (2.0 * statsWindow + nIndex));
+            statsStreamingCalls++;
+        }
+    }
+} /* recursiveCommand */
+
+/* Statistics commands. The first input is the command name:
+ *   'stats'
+ *       Returns a structure of the common statistics (see kernelStats.h) and 
+ *       the number of streaming, Jacobian and recursive calls.
+ *   'stats_reset'
+ *       Zeros the statistics.
+ *   'stats_enable', flag
+ *       Enables (default) or disables the statistics.
+ */
+void statsCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const char *extraFieldNames[] = {"streamingCalls", "jacobianCalls", "recursiveCalls"};
+    char command[16];
+
+    mxGetString(prhs[0], command, sizeof(command));
+    if (strcmp(command, "stats") == 0) {
+        plhs[0] = kernelStats_toStruct(&stats, 3, extraFieldNames);
+        mxSetField(plhs[0], 0, "streamingCalls", mxCreateDoubleScalar(statsStreamingCalls));
+        mxSetField(plhs[0], 0, "jacobianCalls", mxCreateDoubleScalar(statsJacobianCalls));
+        mxSetField(plhs[0], 0, "recursiveCalls", mxCreateDoubleScalar(statsRecursiveCalls));
+    }
+    else if (strcmp(command, "stats_reset") == 0) {
+        kernelStats_reset(&stats);
+        statsStreamingCalls = 0.0;
+        statsJacobianCalls = 0.0;
+        statsRecursiveCalls = 0.0;
+    }
+    else if (strcmp(command, "stats_enable") == 0)
+        kernelStats_enable(&stats, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("HydroSight:doIRFconvolution:invalidInput",
+                "Unknown command: %s", command);
+} /* statsCommand */
+#endif
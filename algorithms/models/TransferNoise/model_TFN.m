@@ -60,7 +60,10 @@ classdef model_TFN < model_abstract
 %       undertaken. However, if the forcing is a daily integral (such as
 %       precipitation or daily pumping volumes) then daily trapazoidal
 %       integration of the weighting function is undertaken and then 
-%       multiplied by the daily flux.
+%       multiplied by the daily flux. If the weighting function is a sum
+%       of exponential terms (for example Pearson's with an integer shape 
+%       parameter) then the integration is undertaken recursively and 
+%       its run time is then independent of the length of the forcing.
 %
 %   Below are links to the details of the public methods of this class. See
 %   the 'model_TFN' constructor for details of how to build a model.
@@ -1403,13 +1406,14 @@ classdef model_TFN < model_abstract
             ntor =  size( tor, 1);                                                     
             clear tor;            
             
+            % NOTE: the maximum index is the same for all time points and so 
+            % only a scalar is stored.
             obj.variables.theta_est_indexes_min = zeros(1,length(time_points) );
-            obj.variables.theta_est_indexes_max = zeros(1,length(time_points) );
+            obj.variables.theta_est_indexes_max = max(1,ntor);
                         
             for ii= 1:length(time_points)              
                 ntheta = sum( obj.inputData.forcingData ( : ,1) <= time_points(ii) );                                
                 obj.variables.theta_est_indexes_min(ii) = ntor-ntheta;
-                obj.variables.theta_est_indexes_max(ii) = max(1,ntor);
             end  
             
             % Free memory within mex function (just in case there'se been a
@@ -1422,6 +1426,11 @@ classdef model_TFN < model_abstract
                 % continue               
             end          
             
+            % Check if the compiled convolution supports streaming. The 
+            % convolution cache is only used for calibration.
+            setConvolutionKernelInfo(obj);
+            obj.variables.useConvolutionCache = false;
+            
             % Get the parameter sets (for use in resetting if >sets)
             [params, param_names] = getParameters(obj);
             nparamsets = size(params,2);
@@ -1567,6 +1576,13 @@ classdef model_TFN < model_abstract
                 % continue               
             end            
                         
+            % Check if the compiled convolution supports streaming and
+            % caching. If so, clear the cache of any prior calibration.
+            setConvolutionKernelInfo(obj);
+            if obj.variables.useConvolutionCache
+                doIRFconvolution('cache_clear');
+            end
+            
             % Get parameter names and initial values
             [params_initial, obj.variables.param_names] = getParameters(obj);
             
@@ -1594,13 +1610,14 @@ classdef model_TFN < model_abstract
             ntor =  size(tor, 1);                                                     
             clear tor;
             
+            % NOTE: the maximum index is the same for all time points and so 
+            % only a scalar is stored.
             obj.variables.theta_est_indexes_min = zeros(1,length(time_points) );
-            obj.variables.theta_est_indexes_max = zeros(1,length(time_points) );
+            obj.variables.theta_est_indexes_max = max(1,ntor);
                         
             for ii= 1:length(time_points)              
                 ntheta = sum( obj.inputData.forcingData ( : ,1) <= time_points(ii) );                                
                 obj.variables.theta_est_indexes_min(ii) = ntor-ntheta;
-                obj.variables.theta_est_indexes_max(ii) = max(1,ntor);
             end  
 
             obj.variables.nobjectiveFunction_calls=0;
@@ -1749,6 +1766,26 @@ classdef model_TFN < model_abstract
             catch
                 % continue               
             end
+            
+            % Store the convolution cache hit and miss counts and free the
+            % cache memory.
+            if isfield(obj.variables,'useConvolutionCache') && obj.variables.useConvolutionCache
+                obj.variables.convolutionCacheStats = doIRFconvolution('cache_stats');
+                doIRFconvolution('cache_clear');
+                obj.variables.useConvolutionCache = false;
+                
+                % Also free the caches of the parallel workers (eg from
+                % the calibration of SP-UCI complexes using parfeval). A
+                % pool is not started if none is open.
+                try
+                    poolobj = gcp('nocreate');
+                    if ~isempty(poolobj)
+                        wait(parfevalOnAll(poolobj, @doIRFconvolution, 0, 'cache_clear'));
+                    end
+                catch
+                    % continue
+                end
+            end
         end        
 
 %% Calculate objective function vector. 
@@ -1897,6 +1934,105 @@ classdef model_TFN < model_abstract
                 objFn = -0.5 * N * ( log(2*pi) + log(objFn./N)+1); 
             end            
         end
+        
+%% Calculate the sensitivity of the head to the response function parameters. 
+        function [jacobian, param_names] = getJacobian(params, time_points, obj)
+% getJacobian calculates the derivative of the head with respect to the response function parameters. 
+%
+% Syntax:
+%   [jacobian, param_names] = getJacobian(params, time_points, obj)
+%
+% Description:
+%   Calculates the derivative of the simulated head at each time point 
+%   with respect to the parameters of each model component having a
+%   response function with an analytical derivative (eg 
+%   responseFunction_Pearsons). Because the convolution is linear in theta, 
+%   the derivatives are derived by doIRFconvolution() in the same pass as 
+%   the head. The drainage elevation is set as per objectiveFunction() and
+%   so, during calibration, the mean of each derivative is removed.
+%   
+%   The Jacobian can be used for gradient based calibration (eg 
+%   Levenberg-Marquardt). It is of the deterministic head only and so the 
+%   noise model parameters are not included. An empty Jacobian is returned
+%   if the model cannot be fully differentiated, that is if any other 
+%   parameter has no analytical derivative. This occurs for:
+%       - components without an analytical derivative (eg 
+%         responseFunction_Hantush or responseFunction_PearsonsHeadConstrained)
+%         and forcing transformations (eg the soil moisture model);
+%       - components having more than one forcing column;
+%       - components whose response function is derived from that of 
+%         another component (eg derivedweighting_PearsonsNegativeRescaled);
+%       - components whose transform_h_star() changes h_star (eg 
+%         responseFunction_JacobsCorrection).
+%   The derivatives of such models must be derived numerically.
+%
+% Input:
+%   params - vector of model parameters
+%
+%   time_points - vector of simulation time points
+%
+%   obj -  model object
+%
+% Outputs:
+%   jacobian - matrix of the derivative of the head at each time point
+%   (rows) with respect to each parameter (columns). Empty if the model
+%   cannot be fully differentiated.
+%
+%   param_names - Nx2 cell array of the component and parameter names for 
+%   each column of jacobian.
+%
+% See also:
+%   model_TFN: model_construction;
+%   objectiveFunction: returns_a_vector_of_innovation_errors_for_calibration;
+%   get_h_star: main_method_for_calculating_the_head_contributions.
+%
+% Author: 
+%   Dr. Tim Peterson, The Department of Infrastructure
+%   Engineering, The University of Melbourne.
+%
+% Date:
+%   18 Oct 2026    
+
+            if ~isfield(obj.variables,'hasConvolutionJacobian') || ~obj.variables.hasConvolutionJacobian
+                error('The compiled doIRFconvolution() does not support the Jacobian. Please rebuild the MEX functions using Build_C_code.m.');
+            end
+            
+            % Set model parameters
+            setParameters(obj, params, obj.variables.param_names);
+            
+            % Calc deterministic component of the head and its derivatives.
+            [~, ~, jacobian, param_names] = get_h_star(obj, time_points);
+            
+            % Return an empty Jacobian if the model cannot be fully
+            % differentiated. The derivative of a component's head with
+            % respect to the parameters of a source component is not
+            % derived and so components having a source response function
+            % cannot be differentiated.
+            hasSourceObject = false;
+            companants = fieldnames(obj.inputData.componentData);
+            for i=1:size(companants,1)
+                componentObj = obj.parameters.(companants{i});
+                if isprop(componentObj, 'settings') && isstruct(componentObj.settings) ...
+                && isfield(componentObj.settings, 'sourceObject')
+                    hasSourceObject = true;
+                end
+            end
+            filt = ~strcmp(obj.variables.param_names(:,1), 'noise');
+            isDerived = ismember(strcat(obj.variables.param_names(filt,1), ':', obj.variables.param_names(filt,2)), ...
+                strcat(param_names(:,1), ':', param_names(:,2)));
+            if hasSourceObject || isempty(jacobian) || ~all(isDerived)
+                jacobian = [];
+                param_names = cell(0,2);
+                return;
+            end
+            
+            % Remove the mean because the drainage elevation is derived
+            % such that the mean simulated head equals the mean observed
+            % head.
+            if obj.variables.doingCalibration
+                jacobian = jacobian - mean(jacobian,1);
+            end
+        end
            
 %% Set the model parameters to the model object from a vector.
         function setParameters(obj, params, param_names)
@@ -2610,11 +2746,12 @@ classdef model_TFN < model_abstract
     methods(Access=protected)
        
 %% Main method calculating the contribution to the head from each model componant.
-        function [h_star, colnames] = get_h_star(obj, time_points, varargin)
+        function [h_star, colnames, dh_star_dp, dh_star_dp_names] = get_h_star(obj, time_points, varargin)
 % get_h_star private method calculating the contribution to the head from each model componant.
 %
 % Syntax:
 %   [h_star, colnames] = get_h_star(obj, time_points)
+%   [h_star, colnames, dh_star_dp, dh_star_dp_names] = get_h_star(obj, time_points)
 %
 % Description:
 %   This method performs the main calculates of the model. The method 
@@ -2660,6 +2797,16 @@ classdef model_TFN < model_abstract
 %
 %   colnames - column names for matrix 'head'.
 %
+%   dh_star_dp - matrix of the derivative of the summed contribution to 
+%   the head with respect to the parameters of each component having a
+%   response function with an analytical derivative (see 
+%   responseFunction_abstract.dtheta_dp). Only derived if requested. The
+%   derivatives of a component whose transform_h_star() changes h_star are
+%   not returned.
+%
+%   dh_star_dp_names - Nx2 cell array of the component and parameter
+%   names for each column of dh_star_dp.
+%
 % Example:
 %   see HydroSight: time_series_model_calibration_and_construction;
 %
@@ -2691,7 +2838,6 @@ classdef model_TFN < model_abstract
             % Calc theta_t for max time to initial time (NOTE: min tor = 0).                        
             filt = obj.inputData.forcingData ( : ,1) <= ceil(time_points(end));
             tor = flipud(transpose(0:time_points(end)  - obj.inputData.forcingData(1,1)+1));
-            tor_end = tor( obj.variables.theta_est_indexes_min(1,:) )';            
             t = obj.inputData.forcingData( filt ,1);
 
             % Calculate the transformation models that DO NOT require the
@@ -2774,19 +2920,40 @@ classdef model_TFN < model_abstract
                 nOutputColumns = nOutputColumns + size(obj.variables.(companants{i}).forcingData,2);
             end            
             
-            % Initialise ouput vector.
-            h_star = zeros( size(time_points,1),  nOutputColumns);       
+            % Initialise ouput matrix of the time, the summed contribution
+            % (if more than one output column) and the contribution from
+            % each componant. Each componant is written directly into its
+            % column. Where the streaming convolution is used, the time
+            % points are convolved in blocks of nRowsPerBlock rows so that,
+            % other than theta and h_star, the memory used does not depend
+            % upon the number of time points.
+            nTimePoints = size(time_points,1);
+            nRowsPerBlock = 8192;
+            if nOutputColumns>1
+                iColumnOffset = 2;
+            else
+                iColumnOffset = 1;
+            end
+            h_star = zeros( nTimePoints,  nOutputColumns + iColumnOffset);
+            h_star(:,1) = time_points;
             iOutputColumns = 0;
+            if ~isfield(obj.variables,'useConvolutionCache')
+                obj.variables.useConvolutionCache = false;
+            end
+            if ~isfield(obj.variables,'useRecursiveConvolution')
+                obj.variables.useRecursiveConvolution = false;
+            end
+            if ~isfield(obj.variables,'useStreamingConvolution')
+                obj.variables.useStreamingConvolution = false;
+            end
+            
+            % Initialise the derivatives of h_star, if requested.
+            doJacobian = nargout > 2;
+            dh_star_dp = zeros( size(time_points,1), 0);
+            dh_star_dp_names = cell(0,2);
             % Calculate each transfer function.
             for i=1:nCompanants
-                                
-                % Calcule theta for each time point of forcing data.
-                theta_est_temp = theta(obj.parameters.( char(companants(i))), tor);                
-
-                % Get analytical esitmates of lower and upper theta tails
-                integralTheta_upperTail = intTheta_upperTail2Inf(obj.parameters.( char(companants(i))), tor_end);                           
-                integralTheta_lowerTail = intTheta_lowerTail(obj.parameters.( char(companants(i))), 1);
-
+                
                 % Get the mean forcing.
                 if ~isempty(varargin) && isfield(varargin{1},companants{i})
                     %forcingMean = obj.variables.(companants{i}).forcingMean                    
@@ -2795,45 +2962,176 @@ classdef model_TFN < model_abstract
                     forcingMean = mean(obj.variables.(companants{i}).forcingData,1);
                 end                
                 
+                % Get the convolution results from prior calls having the
+                % same component parameters, forcing and time points. Only
+                % the columns not within the cache are then calculated.
+                nColumns = size(obj.variables.(companants{i}).forcingData,2);
+                h_star_cached = cell(1, nColumns);
+                if obj.variables.useConvolutionCache && ~doJacobian
+                    cacheKey = getConvolutionCacheKey(obj, companants{i}, tor, time_points);
+                    for j=1:nColumns
+                        h_star_cached{j} = doIRFconvolution('cache_get', [cacheKey; j; isForcingADailyIntegral(i); forcingMean(j)], ...
+                            obj.variables.(companants{i}).forcingData(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1));
+                    end
+                end
+                isCached = ~cellfun(@isempty, h_star_cached);
+                
+                recursiveTerms = [];
+                doBlocks = false;
+                if ~all(isCached)
+                    % Calcule theta for each time point of forcing data.
+                    theta_est_temp = theta(obj.parameters.( char(companants(i))), tor);                
+
+                    % Get analytical esitmate of lower theta tail
+                    integralTheta_lowerTail = intTheta_lowerTail(obj.parameters.( char(companants(i))), 1);
+                    
+                    % Get theta as a sum of exponential terms. If
+                    % available, the convolution is undertaken recursively.
+                    if obj.variables.useRecursiveConvolution && nColumns==1 ...
+                    && ismethod(obj.parameters.( char(companants(i))), 'theta_recursiveTerms')
+                        recursiveTerms = theta_recursiveTerms(obj.parameters.( char(companants(i))));
+                    end
+                    
+                    % Get analytical esitmate of upper theta tail. If the
+                    % streaming convolution is undertaken in blocks of
+                    % time points then it is derived for each block.
+                    doBlocks = obj.variables.useStreamingConvolution && isempty(recursiveTerms) && ~doJacobian;
+                    if ~doBlocks
+                        tor_end = tor( obj.variables.theta_est_indexes_min(1,:) )';
+                        integralTheta_upperTail = intTheta_upperTail2Inf(obj.parameters.( char(companants(i))), tor_end);
+                    end
+                end
+                
+                % Get the derivatives of theta and of the tail integrals
+                % with respect to the component parameters.
+                dtheta = [];
+                if doJacobian && nColumns==1 && ismethod(obj.parameters.( char(companants(i))), 'dtheta_dp')
+                    dtheta = dtheta_dp(obj.parameters.( char(companants(i))), tor);
+                    if ~isempty(dtheta)
+                        [dIntTheta_upperTail, dIntTheta_lowerTail] = dIntTheta_dp(obj.parameters.( char(companants(i))), tor_end, 1);
+                        [~, dtheta_names] = getParameters(obj.parameters.( char(companants(i))));
+                    end
+                end
+                
                 % Integrate transfer function over tor.
-                for j=1: size(theta_est_temp,2)
+                for j=1: nColumns
                     % Increment the output volumn index.
                     iOutputColumns = iOutputColumns + 1;
-
-                    % Try to call doIRFconvolution using Xeon Phi
-                    % Offload coprocessors. This will only work if the
-                    % computer has (1) the intel compiler >2013.1 and (2)
-                    % xeon phi cards. The code first tried to call the
-                    % mex function. 
-                    if ~isfield(obj.variables,'useXeonPhiCard')
-                        obj.variables.useXeonPhiCard = true;
-                    end
-                    
-                    try
-                        if obj.variables.useXeonPhiCard
-                            %display('Offloading convolution algorithm to Xeon Phi coprocessor!');
-                            h_star(:,iOutputColumns) = doIRFconvolutionPhi(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
-                                obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
-                                + integralTheta_upperTail(j,:)' .* forcingMean(j);
-                        else                            
-                            h_star(:,iOutputColumns) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
-                                obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
-                                + integralTheta_upperTail(j,:)' .* forcingMean(j);
+                    iColumn = iColumnOffset + iOutputColumns;
+
+                    % Use the cached convolution.
+                    if isCached(j)
+                        h_star(:,iColumn) = h_star_cached{j};
+                    elseif ~isempty(dtheta)
+                        % Convolve theta and its derivatives in one pass
+                        % of the forcing.
+                        [h_star(:,iColumn), dh_star_dp_component] = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                            obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j), ...
+                            integralTheta_upperTail(j,:), forcingMean(j), [], dtheta, dIntTheta_lowerTail, dIntTheta_upperTail);
+                        dh_star_dp = [dh_star_dp, dh_star_dp_component]; %#ok<AGROW> 
+                        dh_star_dp_names = [dh_star_dp_names; repmat(companants(i), numel(dtheta_names), 1), dtheta_names(:)]; %#ok<AGROW> 
+                    else
+                        % Try to call doIRFconvolution using Xeon Phi
+                        % Offload coprocessors. This will only work if the
+                        % computer has (1) the intel compiler >2013.1 and (2)
+                        % xeon phi cards. The code first tried to call the
+                        % mex function. 
+                        if ~isfield(obj.variables,'useXeonPhiCard')
+                            obj.variables.useXeonPhiCard = true;
                         end
+                    
+                        % Use the streaming convolution if it is supported
+                        % by the compiled doIRFconvolution. The upper tail
+                        % correction is then added within the kernel and the
+                        % output written directly, avoiding the temporary
+                        % vectors of the non-streaming call.
+                        try
+                            if doBlocks
+                                % Streaming convolution of each block of
+                                % time points, written directly into h_star.
+                                for iRow=1:nRowsPerBlock:nTimePoints
+                                    rows = iRow:min(iRow+nRowsPerBlock-1, nTimePoints);
+                                    integralTheta_upperTail_rows = intTheta_upperTail2Inf(obj.parameters.( char(companants(i))), ...
+                                        tor( obj.variables.theta_est_indexes_min(1,rows) )');
+                                    h_star(rows,iColumn) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min(1,rows), obj.variables.theta_est_indexes_max(1), ...
+                                        obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j), ...
+                                        integralTheta_upperTail_rows(j,:), forcingMean(j));
+                                end
+                            elseif ~isempty(recursiveTerms)
+                                % Recursive convolution. If the terms do not
+                                % reproduce theta then the compiled function
+                                % undertakes the streaming convolution.
+                                h_star(:,iColumn) = doIRFconvolution('recursive', recursiveTerms, theta_est_temp(:,j), ...
+                                    obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                    obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j), ...
+                                    integralTheta_upperTail(j,:), forcingMean(j));
+                            elseif obj.variables.useStreamingConvolution
+                                h_star(:,iColumn) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                    obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j), ...
+                                    integralTheta_upperTail(j,:), forcingMean(j));
+                            elseif obj.variables.useXeonPhiCard
+                                %display('Offloading convolution algorithm to Xeon Phi coprocessor!');
+                                h_star(:,iColumn) = doIRFconvolutionPhi(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                    obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
+                                    + integralTheta_upperTail(j,:)' .* forcingMean(j);
+                            else                            
+                                h_star(:,iColumn) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                    obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
+                                    + integralTheta_upperTail(j,:)' .* forcingMean(j);
+                            end
                             
-                    catch
-                        %display('Offloading convolution algorithm to Xeon Phi coprocessor failed - falling back to CPU!');
-                        obj.variables.useXeonPhiCard = false;
-                        h_star(:,iOutputColumns) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
-                                obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
-                                + integralTheta_upperTail(j,:)' .* forcingMean(j);
-                    end                    
+                        catch
+                            %display('Offloading convolution algorithm to Xeon Phi coprocessor failed - falling back to CPU!');
+                            obj.variables.useXeonPhiCard = false;
+                            obj.variables.useStreamingConvolution = false;
+                            obj.variables.useRecursiveConvolution = false;
+                            if doBlocks
+                                tor_end = tor( obj.variables.theta_est_indexes_min(1,:) )';
+                                integralTheta_upperTail = intTheta_upperTail2Inf(obj.parameters.( char(companants(i))), tor_end);
+                                doBlocks = false;
+                            end
+                            h_star(:,iColumn) = doIRFconvolution(theta_est_temp(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                    obj.variables.(companants{i}).forcingData(:,j), isForcingADailyIntegral(i), integralTheta_lowerTail(j))' ...
+                                    + integralTheta_upperTail(j,:)' .* forcingMean(j);
+                        end                    
+                        
+                        % Add the convolution to the cache. The cache key is
+                        % only derived when the Jacobian is not requested.
+                        if obj.variables.useConvolutionCache && ~doJacobian
+                            doIRFconvolution('cache_put', [cacheKey; j; isForcingADailyIntegral(i); forcingMean(j)], ...
+                                obj.variables.(companants{i}).forcingData(:,j), obj.variables.theta_est_indexes_min, obj.variables.theta_est_indexes_max(1), ...
+                                h_star(:,iColumn));
+                        end
+                    end
+                    
                     % Transform the h_star estimate for the current
                     % componant. This feature was included so that h_star
                     % estimate fro groundwater pumping could be corrected 
                     % for an unconfined aquifer using Jacobs correction.
                     % Peterson Feb 2013.
-                    h_star(:,iOutputColumns) = transform_h_star(obj.parameters.( char(companants(i))), [time_points, h_star(:,iOutputColumns)]);
+                    % The transformation is undertaken for each block of
+                    % time points.
+                    if doJacobian
+                        h_star_untransformed = h_star(:,iColumn);
+                    end
+                    for iRow=1:nRowsPerBlock:nTimePoints
+                        rows = iRow:min(iRow+nRowsPerBlock-1, nTimePoints);
+                        h_star(rows,iColumn) = transform_h_star(obj.parameters.( char(companants(i))), [time_points(rows), h_star(rows,iColumn)]);
+                    end
+                    
+                    % The derivatives are of the untransformed h_star.
+                    % Hence, they are removed if the transformation changed
+                    % h_star.
+                    if doJacobian && any(h_star(:,iColumn) ~= h_star_untransformed)
+                        filt_component = strcmp(dh_star_dp_names(:,1), companants{i});
+                        dh_star_dp = dh_star_dp(:,~filt_component);
+                        dh_star_dp_names = dh_star_dp_names(~filt_component,:);
+                    end
+                    
+                    % Add the componant to the summed contribution.
+                    if nOutputColumns>1
+                        h_star(:,2) = h_star(:,2) + h_star(:,iColumn);
+                    end
                         
                     % Add output name to the cell array
                     if ischar(obj.variables.(companants{i}).forcingData_colnames)
@@ -2844,17 +3142,81 @@ classdef model_TFN < model_abstract
                 end
             end
             
-            % Sum all componants (excluding soil moisture) and add time
-            % vector.
-            if size(h_star,2)>1
-                h_star = [time_points , sum(h_star,2), h_star];
+            % Add the names of the time vector and the summed componants
+            % (excluding soil moisture). These are within h_star.
+            if nOutputColumns>1
                 colnames = ['time','Head',colnames];
             else
-                h_star = [ time_points, h_star];
                 colnames = {'time','Head'};               
             end
                                 
         end
+        
+%% Get the features supported by the compiled convolution function.
+        function setConvolutionKernelInfo(obj)
+            % Calling doIRFconvolution() with empty inputs returns a
+            % structure of the kernel features as the second output. Builds
+            % of doIRFconvolution.c prior to the streaming convolution do
+            % not return the second output and so an error is thrown and
+            % the non-streaming convolution is used.
+            try
+                [~, kernelInfo] = doIRFconvolution([], [], [], [], false, 0);
+                obj.variables.useStreamingConvolution = kernelInfo.streaming;
+                obj.variables.useConvolutionCache = isfield(kernelInfo, 'cache') && kernelInfo.cache;
+                obj.variables.hasConvolutionJacobian = isfield(kernelInfo, 'jacobian') && kernelInfo.jacobian;
+                obj.variables.useRecursiveConvolution = isfield(kernelInfo, 'recursive') && kernelInfo.recursive;
+            catch
+                obj.variables.useStreamingConvolution = false;
+                obj.variables.useConvolutionCache = false;
+                obj.variables.hasConvolutionJacobian = false;
+                obj.variables.useRecursiveConvolution = false;
+            end
+        end
+        
+%% Get the key for caching the convolution of a model component.
+        function cacheKey = getConvolutionCacheKey(obj, componentName, tor, time_points)
+            % The key is the component name, the component's response
+            % function parameters, the numeric settings of the response
+            % function (eg t_limit and weight_at_limit of
+            % responseFunction_Pearsons, which change theta but are not
+            % parameters) and the length and ends of tor and of the time
+            % points. For derived response functions (eg 
+            % derivedweighting_PearsonsPositiveRescaled) the parameters and
+            % numeric settings of the source response function are also
+            % included. The forcing and the time point indexes are added to
+            % the key within doIRFconvolution(). Theta is first evaluated at
+            % the first tor value (the longest) so that the settings derived
+            % within theta (eg weight_at_limit) are those of the current
+            % parameters and not of the prior call.
+            componentObj = obj.parameters.(componentName);
+            theta(componentObj, tor(1));
+            cacheKey = [double(componentName(:)); numel(componentName); ...
+                numel(tor); tor(1); tor(end); numel(time_points); time_points(1); time_points(end)];
+            while ~isempty(componentObj)
+                params = getParameters(componentObj);
+                cacheKey = [cacheKey; params(:)]; %#ok<AGROW> 
+                
+                % Add the numeric and logical scalar settings, and their
+                % number so that differing settings give differing keys.
+                sourceObj = [];
+                if isprop(componentObj, 'settings') && isstruct(componentObj.settings)
+                    fnames = fieldnames(componentObj.settings);
+                    nSettings = 0;
+                    for k=1:numel(fnames)
+                        value = componentObj.settings.(fnames{k});
+                        if (isnumeric(value) || islogical(value)) && isscalar(value)
+                            cacheKey = [cacheKey; double(value)]; %#ok<AGROW> 
+                            nSettings = nSettings + 1;
+                        end
+                    end
+                    cacheKey = [cacheKey; nSettings]; %#ok<AGROW> 
+                    if isfield(componentObj.settings, 'sourceObject')
+                        sourceObj = componentObj.settings.sourceObject;
+                    end
+                end
+                componentObj = sourceObj;
+            end
+        end
     end
     
 
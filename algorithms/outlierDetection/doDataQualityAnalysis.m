@@ -29,108 +29,26 @@ function [headData,noise_sigma, ARMA_params, exp_model] = doDataQualityAnalysis(
         headData = headData{:,1:2};
     end
 
-    % Filter for plausible dates
-    filt_date = false(size(headData,1),1);
-    if checkMinSartDate
-        filt_date = headData(:,1) < constuction_date;
-    end
-    if checkMaxEndDate
-        filt_date = headData(:,1)>now() | filt_date;
-    end    
-    isErrorObs = filt_date;
-
-    % Filter date duplicates
-    filt_duplicates = false(size(headData,1),1);
-    if chechDuplicateDates
-        timeStep = [diff( headData(:,1)); inf];
-        filt_duplicates = abs(timeStep) <sqrt(eps);    
-        filt_duplicates(isErrorObs) = false;        
-    end
-    isErrorObs = filt_date | filt_duplicates;
-
-    % Check head is above the bottom of the bore.
-    filt_minHead = false(size(headData,1),1);
-    if checkMinHead                    
-        filt_minHead_tmp = headData(~isErrorObs,2) < surface_elevation - boreDepth;        
-        filt_minHead(~isErrorObs ) = filt_minHead_tmp;
-        clear filt_minHead_tmp;    
-    end
-    isErrorObs = filt_date | filt_duplicates | filt_minHead;
-
-    
-    % Check the head is below the top of the casing (assumes the aquifer is
-    % unconfined)
-    filt_maxHead = false(size(headData,1),1);
-    if checkMaxHead
-        filt_maxHead_tmp = headData(~isErrorObs,2) > surface_elevation + casing_length;        
-        filt_maxHead(~isErrorObs ) = filt_maxHead_tmp;
-        clear filt_maxHead_tmp;
-    end
-    isErrorObs = filt_date | filt_duplicates | filt_minHead | filt_maxHead;
-
-    
-    % Filter for rapd change in headData
-    filt_rapid = false(size(headData,1),1);        
-    d_headData_dt = diff( headData(~isErrorObs,2))./ diff( headData(~isErrorObs,1));
-    filt_rapid(~isErrorObs) = [false; abs(d_headData_dt) >= RateofChangeThreshold];          
-    isErrorObs = filt_date | filt_duplicates | filt_minHead | filt_maxHead | filt_rapid;
-            
-    % Filter out bore with a constant head for > 'ConstHeadThreshold' days. First the
-    % duration of 'flat' periods is assessed.
-    filt_flatExtendedDuration = false(size(isErrorObs,1),1);
-    if RateofChangeThreshold>0
-        headData_tmp = headData(~isErrorObs,:);    
-        delta_headData_fwd = [false; headData_tmp(2:end,2) - headData_tmp(1:end-1,2)];
-        delta_headData_rvs = [headData_tmp(1:end-1,2) - headData_tmp(2:end,2); false];
-        filt_flat = delta_headData_fwd==0 | delta_headData_rvs==0;
-        if any(filt_flat)
-
-            filt_flatExtendedDuration_tmp = false(sum(~isErrorObs),1);
-
-            % Filt out prior identified errors
-            headData_filt = headData(~isErrorObs,:);
-
-            startDate = 0;
-            endDate = 0; %#ok<NASGU> 
-            startheadData = nan;
-            for j=2:size(headData_filt,1)
-                try
-                    if (filt_flat(j) && ~filt_flat(j-1)) || (j==2 && filt_flat(j))
-                        if j==2 && filt_flat(j-1)
-                            startDate = headData_filt(j-1,1)-sqrt(eps());
-                            startheadData = headData_filt(j-1,2);
-                        else
-                            startDate = headData_filt(j,1);
-                            startheadData = headData_filt(j,2);
-                        end                            
-                        endDate = 0;                            %#ok<NASGU> 
-                    elseif startDate>0 && (~filt_flat(j) || j==size(headData_filt,1) || headData_filt(j,2)~=startheadData) 
-                        endDate = headData_filt(j,1);
-                        if j==size(headData_filt,1) && headData_filt(j,2)==headData_filt(j-1,2)
-                            endDate = endDate+sqrt(eps());
-                        end
-
-                        % Assess if the zero period is >60 days long
-                        % and are > constHeadThreshold_minObs
-                        filt_tmp = headData_filt(:,1)>= startDate & headData_filt(:,1) < endDate;
-                        consHead_dates =  headData_filt(filt_tmp,1);
-                        if  consHead_dates(end) - consHead_dates(1) >= ConstHeadThreshold ...
-                        &&  sum(filt_tmp)>=constHeadThreshold_minObs       
-                            filt_flatExtendedDuration_tmp(filt_tmp) = true;
-                        end    
-
-                        % Reset markers
-                        startDate = 0;
-                        endDate = 0;   %#ok<NASGU> 
-                        startheadData = nan;                            
-                    end
-                catch
-                   disp('Error: Rateof Change Threshold caused an unexpected error.'); 
-                end
-            end     
-            filt_flatExtendedDuration = false(size(isErrorObs,1),1);
-            filt_flatExtendedDuration(~isErrorObs) = filt_flatExtendedDuration_tmp;
-        end
+    % Undertake the date, duplicate, minimum and maximum head, rate of change
+    % and constant head checks. The checks are undertaken by the native
+    % kernel doDataQualityScreening() in linear time. If it is not compiled
+    % then the MATLAB implementation, doErrorChecks(), is used.
+    if exist('doDataQualityScreening','file')==3
+        settings = [checkMinSartDate, checkMaxEndDate, chechDuplicateDates, checkMinHead, checkMaxHead, ...
+            constuction_date, now(), surface_elevation - boreDepth, surface_elevation + casing_length, ...
+            RateofChangeThreshold, ConstHeadThreshold, constHeadThreshold_minObs];
+        errorFlags = doDataQualityScreening(headData(:,1), headData(:,2), double(settings));
+        filt_date = errorFlags(:,1);
+        filt_duplicates = errorFlags(:,2);
+        filt_minHead = errorFlags(:,3);
+        filt_maxHead = errorFlags(:,4);
+        filt_rapid = errorFlags(:,5);
+        filt_flatExtendedDuration = errorFlags(:,6);
+    else
+        [filt_date, filt_duplicates, filt_minHead, filt_maxHead, filt_rapid, filt_flatExtendedDuration] = ...
+            doErrorChecks(headData, boreDepth, surface_elevation, casing_length, constuction_date, checkMinSartDate, ...
+            checkMaxEndDate, chechDuplicateDates, checkMinHead, checkMaxHead, RateofChangeThreshold, ConstHeadThreshold, ...
+            constHeadThreshold_minObs);
     end
 
     % Aggregare Errors filters
@@ -176,7 +94,3 @@ function [headData,noise_sigma, ARMA_params, exp_model] = doDataQualityAnalysis(
         'VariableNames',{'Year', 'Month', 'Day', 'Hour', 'Minute', 'Head', 'Date_Error', 'Duplicate_Date_Error', 'Min_Head_Error','Max_Head_Error','Rate_of_Change_Error','Const_Hear_Error','Outlier_Obs'});
 
 end
-
-
-                   
-                
@@ -0,0 +1,230 @@
+#include "math.h"
+#include "float.h"
+#include "stdlib.h"
+#include "string.h"
+#ifdef MATLAB_MEX_FILE
+#include "mex.h"
+#endif
+#include "../hydroSightKernels.h"
+
+/* doDataQualityScreening undertakes the error checks of doDataQualityAnalysis.m in linear time.
+ *
+ * Syntax:
+ *   errorFlags = doDataQualityScreening(time, head, settings)
+ *   errorFlags = doDataQualityScreening(time, head, settings), where time and head are cell arrays
+ *
+ * Description:
+ *   The observations must be sorted by time. settings is a vector of:
+ *     1. checkMinSartDate (logical)
+ *     2. checkMaxEndDate (logical)
+ *     3. chechDuplicateDates (logical)
+ *     4. checkMinHead (logical)
+ *     5. checkMaxHead (logical)
+ *     6. construction date
+ *     7. current date (ie now())
+ *     8. minimum plausible head (ie surface elevation - bore depth)
+ *     9. maximum plausible head (ie surface elevation + casing length)
+ *    10. RateofChangeThreshold
+ *    11. ConstHeadThreshold (days)
+ *    12. constHeadThreshold_minObs
+ *
+ *   errorFlags is an N x 6 logical matrix of the date, duplicate date,
+ *   minimum head, maximum head, rate of change and constant head errors.
+ *   As per doDataQualityAnalysis.m, each check only considers the
+ *   observations not failing a prior check.
+ *
+ *   The date, duplicate, head range and rate of change checks are undertaken
+ *   in a single sweep of the observations. The constant head periods are then
+ *   found in one pass of the remaining observations. Because the observations
+ *   are sorted, the observations within each constant head period are found
+ *   from the start and end of the period rather than by a search of the whole
+ *   record (as was undertaken by doDataQualityAnalysis.m).
+ *
+ *   If time and head are cell arrays then the bores are screened in parallel
+ *   (when compiled with OpenMP) and errorFlags is a cell array. settings is
+ *   then a matrix with one row per bore, or a single row for all bores.
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifdef MATLAB_MEX_FILE
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const int isBatch = nrhs == 3 && mxIsCell(prhs[0]);
+    const int nBores = isBatch ? (int) mxGetNumberOfElements(prhs[0]) : 1;
+    const double **time, **head, *settings;
+    double *boreSettings;
+    unsigned char **flags;
+    mxLogical **errorFlags;
+    int *nObs, iBore, i, j, nSettingRows;
+    const mxArray *timeArray, *headArray;
+
+    if (nrhs != 3 || (isBatch && (!mxIsCell(prhs[1]) || (int) mxGetNumberOfElements(prhs[1]) != nBores)))
+        mexErrMsgIdAndTxt("HydroSight:doDataQualityScreening:invalidInput",
+                "The inputs must be time, head and settings. For a batch of bores, time and head must be cell arrays of equal size.");
+    if (!mxIsDouble(prhs[2]) || mxGetN(prhs[2]) != SCREENING_N_SETTINGS
+    || (mxGetM(prhs[2]) != 1 && (int) mxGetM(prhs[2]) != nBores))
+        mexErrMsgIdAndTxt("HydroSight:doDataQualityScreening:invalidInput",
+                "settings must have %d columns and one row, or one row per bore.", SCREENING_N_SETTINGS);
+    settings = mxGetPr(prhs[2]);
+    nSettingRows = (int) mxGetM(prhs[2]);
+
+    /* Get the inputs and create the outputs. The MATLAB API is not thread
+     * safe and so this is undertaken prior to the parallel screening. */
+    time = (const double **) mxCalloc(nBores > 0 ? nBores : 1, sizeof(double *));
+    head = (const double **) mxCalloc(nBores > 0 ? nBores : 1, sizeof(double *));
+    nObs = (int *) mxCalloc(nBores > 0 ? nBores : 1, sizeof(int));
+    flags = (unsigned char **) mxCalloc(nBores > 0 ? nBores : 1, sizeof(unsigned char *));
+    errorFlags = (mxLogical **) mxCalloc(nBores > 0 ? nBores : 1, sizeof(mxLogical *));
+    boreSettings = (double *) mxCalloc((nBores > 0 ? nBores : 1) * SCREENING_N_SETTINGS, sizeof(double));
+    if (isBatch)
+        plhs[0] = mxCreateCellMatrix(mxGetM(prhs[0]), mxGetN(prhs[0]));
+    for (iBore = 0; iBore < nBores; iBore++) {
+        timeArray = isBatch ? mxGetCell(prhs[0], iBore) : prhs[0];
+        headArray = isBatch ? mxGetCell(prhs[1], iBore) : prhs[1];
+        if (timeArray == NULL || headArray == NULL || !mxIsDouble(timeArray) || !mxIsDouble(headArray)
+        || mxGetNumberOfElements(timeArray) != mxGetNumberOfElements(headArray))
+            mexErrMsgIdAndTxt("HydroSight:doDataQualityScreening:invalidInput",
+                    "time and head must be double vectors of equal length (see bore %d).", iBore + 1);
+        nObs[iBore] = (int) mxGetNumberOfElements(timeArray);
+        time[iBore] = mxGetPr(timeArray);
+        head[iBore] = mxGetPr(headArray);
+        flags[iBore] = (unsigned char *) mxCalloc(nObs[iBore] * SCREENING_N_FLAGS + 1, sizeof(unsigned char));
+        for (j = 0; j < SCREENING_N_SETTINGS; j++)
+            boreSettings[iBore * SCREENING_N_SETTINGS + j] = settings[j * nSettingRows + (nSettingRows == 1 ? 0 : iBore)];
+
+        if (isBatch)
+            mxSetCell(plhs[0], iBore, mxCreateLogicalMatrix(nObs[iBore], SCREENING_N_FLAGS));
+        else
+            plhs[0] = mxCreateLogicalMatrix(nObs[iBore], SCREENING_N_FLAGS);
+        errorFlags[iBore] = mxGetLogicals(isBatch ? mxGetCell(plhs[0], iBore) : plhs[0]);
+    }
+
+    #pragma omp parallel for private(i) schedule(dynamic,1)
+    for (iBore = 0; iBore < nBores; iBore++) {
+        dataQualityScreening(nObs[iBore], time[iBore], head[iBore], boreSettings + iBore * SCREENING_N_SETTINGS, flags[iBore]);
+        for (i = 0; i < nObs[iBore] * SCREENING_N_FLAGS; i++)
+            errorFlags[iBore][i] = flags[iBore][i] != 0;
+    }
+
+    for (iBore = 0; iBore < nBores; iBore++)
+        mxFree(flags[iBore]);
+    mxFree((void *) time);
+    mxFree((void *) head);
+    mxFree(nObs);
+    mxFree(flags);
+    mxFree(errorFlags);
+    mxFree(boreSettings);
+}
+#endif
+
+/* Screens the observations of one bore. flags is nObs x SCREENING_N_FLAGS
+ * (column major). It is independent of MATLAB so that it can be called
+ * from multiple threads.
+ */
+void dataQualityScreening(const int nObs, const double *time, const double *head, const double *settings,
+        unsigned char *flags)
+{
+    unsigned char *isDateError = flags, *isDuplicate = flags + nObs, *isBelowMin = flags + 2*nObs,
+            *isAboveMax = flags + 3*nObs, *isRapidChange = flags + 4*nObs, *isConstHead = flags + 5*nObs;
+    const int checkMinStartDate = settings[0] != 0.0, checkMaxEndDate = settings[1] != 0.0,
+            checkDuplicateDates = settings[2] != 0.0, checkMinHead = settings[3] != 0.0, checkMaxHead = settings[4] != 0.0;
+    const double constructionDate = settings[5], currentDate = settings[6], minHead = settings[7], maxHead = settings[8],
+            rateOfChangeThreshold = settings[9], constHeadThreshold = settings[10], constHeadThreshold_minObs = settings[11];
+    const double tol = sqrt(DBL_EPSILON);
+    double startDate, endDate, startHead;
+    int *obs, nValid = 0, i, j, k, prev = -1, isFlat, isFlat_prev, runStart = 0, lower, upper;
+
+    memset(flags, 0, nObs * SCREENING_N_FLAGS * sizeof(unsigned char));
+    if (nObs <= 0)
+        return;
+    obs = (int *) malloc(nObs * sizeof(int));
+
+    /* Sweep the observations for the date, duplicate, head range and rate
+     * of change errors. obs is the indexes of the observations with none
+     * of these errors. */
+    for (i = 0; i < nObs; i++) {
+        isDateError[i] = (checkMinStartDate && time[i] < constructionDate) || (checkMaxEndDate && time[i] > currentDate);
+        if (isDateError[i])
+            continue;
+
+        isDuplicate[i] = checkDuplicateDates && i < nObs - 1 && fabs(time[i+1] - time[i]) < tol;
+        if (isDuplicate[i])
+            continue;
+
+        isBelowMin[i] = checkMinHead && head[i] < minHead;
+        if (isBelowMin[i])
+            continue;
+
+        isAboveMax[i] = checkMaxHead && head[i] > maxHead;
+        if (isAboveMax[i])
+            continue;
+
+        /* Rate of change from the prior observation passing the above checks. */
+        isRapidChange[i] = prev >= 0 && fabs((head[i] - head[prev]) / (time[i] - time[prev])) >= rateOfChangeThreshold;
+        prev = i;
+        if (!isRapidChange[i])
+            obs[nValid++] = i;
+    }
+
+    /* Find the periods of constant head. As per doDataQualityAnalysis.m, an
+     * observation is flat if the change from the prior or to the next
+     * observation is zero (the first and last observations are always
+     * flat), a period starts at a flat observation following a non-flat
+     * observation and it ends at a non-flat observation, a change in head or
+     * the last observation. */
+    #define TIME(j) time[obs[j]]
+    #define HEAD(j) head[obs[j]]
+    #define IS_FLAT(j) ((j) == 0 || HEAD(j) - HEAD((j)-1) == 0.0 || (j) == nValid - 1 || HEAD(j) - HEAD((j)+1) == 0.0)
+    if (rateOfChangeThreshold > 0.0 && nValid > 1) {
+        startDate = 0.0;
+        startHead = NAN;
+        isFlat_prev = IS_FLAT(0);
+        for (j = 1; j < nValid; j++) {
+            isFlat = IS_FLAT(j);
+            if ((isFlat && !isFlat_prev) || (j == 1 && isFlat)) {
+                runStart = j == 1 && isFlat_prev ? 0 : j;
+                startDate = runStart == 0 ? TIME(0) - tol : TIME(j);
+                startHead = HEAD(runStart);
+            }
+            else if (startDate > 0.0 && (!isFlat || j == nValid - 1 || HEAD(j) != startHead)) {
+                endDate = TIME(j);
+                if (j == nValid - 1 && HEAD(j) == HEAD(j-1))
+                    endDate = endDate + tol;
+
+                /* The period is the observations with startDate <= time < endDate. */
+                lower = runStart;
+                while (lower > 0 && TIME(lower - 1) >= startDate)
+                    lower--;
+                upper = j + 1;
+                while (upper > lower && !(TIME(upper - 1) < endDate))
+                    upper--;
+
+                /* An empty period caused an error within doDataQualityAnalysis.m
+                 * and the period was not reset. */
+                if (upper <= lower) {
+                    isFlat_prev = isFlat;
+                    continue;
+                }
+
+                if (TIME(upper - 1) - TIME(lower) >= constHeadThreshold && upper - lower >= constHeadThreshold_minObs)
+                    for (k = lower; k < upper; k++)
+                        isConstHead[obs[k]] = 1;
+
+                startDate = 0.0;
+                startHead = NAN;
+            }
+            isFlat_prev = isFlat;
+        }
+    }
+    #undef TIME
+    #undef HEAD
+    #undef IS_FLAT
+
+    free(obs);
+}
@@ -0,0 +1,102 @@
+/* timeSeriesStore.h - memory-mapped columnar store of time series.
+ *
+ * A store is a single binary file holding many time series, each keyed by a
+ * site (eg a bore ID or climate grid cell) and a variable (eg precip, et or
+ * head). Each series has a column of times (as MATLAB date numbers) and a
+ * column of values. The columns are 64 byte aligned and, for each site,
+ * identical time columns are stored only once.
+ *
+ * The store is opened read-only by mapping the file into memory (mmap() or
+ * MapViewOfFile()). The columns can then be used by the native programs (eg
+ * TFN_batch) without a copy, and native processes on a node reading the same
+ * store share the one page cached copy of the file. This does not extend to
+ * MATLAB. The MEX read returns a copy of the series, and HydroSightModel and
+ * model_TFN objects, including those sent to parfor workers, hold their own
+ * copies of the forcing and head.
+ *
+ * File layout (little endian):
+ *   header     magic "HSTSTORE", version, byte order mark, number of series
+ *              and the offset to the directory (32 bytes).
+ *   columns    the time and value columns (doubles).
+ *   directory  one entry per series (128 bytes), sorted by site and then
+ *              variable.
+ *
+ * The store is written, listed and read from MATLAB using the MEX function
+ * timeSeriesStore (see algorithms/utilities/timeSeriesStore.c).
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "stddef.h"
+#include "stdint.h"
+#ifdef _WIN32
+#include "windows.h"
+#endif
+
+#define TSSTORE_MAGIC "HSTSTORE"
+#define TSSTORE_VERSION 1
+#define TSSTORE_BYTE_ORDER_MARK 0x01020304u
+#define TSSTORE_SITE_LENGTH 64
+#define TSSTORE_VARIABLE_LENGTH 32
+#define TSSTORE_ALIGNMENT 64
+#define TSSTORE_MESSAGE_LENGTH 256
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t nSeries;
+    uint64_t directoryOffset;
+} tsStoreHeader;
+
+typedef struct {
+    char site[TSSTORE_SITE_LENGTH];
+    char variable[TSSTORE_VARIABLE_LENGTH];
+    uint64_t nValues;
+    uint64_t timeOffset;
+    uint64_t valueOffset;
+    uint64_t reserved;
+} tsStoreEntry;
+
+/* An open (ie mapped) store. */
+typedef struct {
+    const char *base;
+    size_t size;
+    int nSeries;
+    const tsStoreEntry *entries;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+} tsStore;
+
+/* Map the store read-only. Returns 1 on success or 0 with the reason within message. */
+int tsStore_open(const char *fileName, tsStore *store, char *message);
+
+/* Unmap the store. */
+void tsStore_close(tsStore *store);
+
+/* Index of the series for the site and variable, or -1 if not within the store. */
+int tsStore_find(const tsStore *store, const char *site, const char *variable);
+
+/* Length, times and values of series i. The pointers are into the mapped
+ * file and are valid until the store is closed. */
+size_t tsStore_length(const tsStore *store, const int i);
+const double *tsStore_time(const tsStore *store, const int i);
+const double *tsStore_values(const tsStore *store, const int i);
+
+/* Write a store of nSeries series. Site and variable pairs must be unique.
+ * Returns 1 on success or 0 with the reason within message. */
+int tsStore_write(const char *fileName, const int nSeries, const char **sites, const char **variables,
+        const size_t *nValues, const double **time, const double **values, char *message);
+
+#endif
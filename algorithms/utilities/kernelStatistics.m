@@ -0,0 +1,82 @@
+function stats = kernelStatistics(command)
+%kernelStatistics Get, reset, enable or disable the MEX kernel run time statistics.
+%
+% Syntax:
+%   stats = kernelStatistics()
+%   stats = kernelStatistics('get')
+%   kernelStatistics('enable')
+%   kernelStatistics('disable')
+%   kernelStatistics('reset')
+%
+% Description:
+%   The MEX kernels doIRFconvolution, forcingTransform_soilMoisture,
+%   doExpSmoothing and DREAM_generation can record the number of calls,
+%   output points, wall time and bytes touched (see algorithms/kernelStats.h).
+%   The recording is off by default and is turned on with 'enable'.
+%
+%   'get' returns a structure with one field per kernel. In addition to the
+%   statistics returned by the kernel, the mean time per call (s), the time
+%   per point (ns) and the effective bandwidth (GB/s) are derived. For
+%   forcingTransform_soilMoisture the histograms of the Newton-Raphson and
+%   bisection iterations per day, and the number of days reaching the
+%   maximum iterations, are also returned.
+%
+%   Kernels that are not compiled, or were compiled prior to the statistics
+%   being added, are omitted.
+%
+%   Note, the statistics are held within each MATLAB process. When
+%   calibrating using a parallel pool, the statistics of the workers must be
+%   enabled and collected on the workers (eg using parfevalOnAll).
+%
+% Example:
+%   kernelStatistics('reset');
+%   kernelStatistics('enable');
+%   calibrateModel(model, [], 0, inf, 'SP-UCI', 2);
+%   stats = kernelStatistics('get');
+%   kernelStatistics('disable');
+%
+% Author:
+%   Dr. Tim Peterson, The Department of Infrastructure
+%   Engineering, The University of Melbourne.
+%
+% Date:
+%   18 Oct 2026
+
+    if nargin==0
+        command = 'get';
+    end
+
+    kernels = {'doIRFconvolution','forcingTransform_soilMoisture','doExpSmoothing','DREAM_generation'};
+
+    stats = struct();
+    for i=1:length(kernels)
+        if exist(kernels{i},'file')~=3
+            continue
+        end
+
+        try
+            switch lower(command)
+                case 'get'
+                    s = feval(kernels{i},'stats');
+                    s.timePerCall = s.wallTime ./ max(s.calls,1);
+                    s.nsPerPoint = 1e9 .* s.wallTime ./ max(s.points,1);
+                    s.bandwidth = s.bytes ./ max(s.wallTime, eps) ./ 1e9;
+                    stats.(kernels{i}) = s;
+                case 'enable'
+                    feval(kernels{i},'stats_enable', true);
+                case 'disable'
+                    feval(kernels{i},'stats_enable', false);
+                case 'reset'
+                    feval(kernels{i},'stats_reset');
+                otherwise
+                    error('HydroSight:kernelStatistics:invalidInput', ...
+                        'The command must be ''get'', ''enable'', ''disable'' or ''reset''.');
+            end
+        catch ME
+            if strcmp(ME.identifier,'HydroSight:kernelStatistics:invalidInput')
+                rethrow(ME);
+            end
+            % The kernel does not support the statistics commands.
+        end
+    end
+end
@@ -0,0 +1,597 @@
+/* timeSeriesStore - write, list and read a memory-mapped store of time series.
+ *
+ * The store format is described within algorithms/timeSeriesStore.h. The
+ * store functions (tsStore_*) are independent of MATLAB so that they can be
+ * linked into the native batch runner (see
+ * algorithms/models/TransferNoise/batch/TFN_batch.c). When compiled by mex,
+ * the following commands are available from MATLAB:
+ *
+ *   timeSeriesStore('write', fileName, sites, variables, data)
+ *       Writes the store. sites and variables are cell arrays of strings
+ *       and data is a cell array of Nx2 matrices of [time, value], with time
+ *       as a MATLAB date number. The store is written to a temporary file and
+ *       then renamed so that processes reading a prior version are unaffected.
+ *
+ *   list = timeSeriesStore('list', fileName)
+ *       Returns a structure array of the site, variable, nValues, startTime
+ *       and endTime of each series.
+ *
+ *   data = timeSeriesStore('read', fileName, site, variables)
+ *       Returns the matrix [time, value1, value2, ...] of the site for the
+ *       variable(s), ie in the same form as HydroSight forcing data. Multiple
+ *       variables must have the same times.
+ *
+ *   timeSeriesStore('close'[, fileName])
+ *       Unmaps the store(s).
+ *
+ * The stores are kept mapped between calls and are remapped if the file is
+ * rewritten. Note, a MATLAB matrix must own its memory and so 'read' copies
+ * the columns from the mapping. The memory used by MATLAB is therefore the
+ * same as for series read from a text file. Only the native kernels (eg
+ * TFN_batch) use the mapped columns without a copy.
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "sys/types.h"
+#include "sys/stat.h"
+#ifndef _WIN32
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#endif
+#ifdef MATLAB_MEX_FILE
+#include "mex.h"
+#endif
+#include "../timeSeriesStore.h"
+
+#ifdef MATLAB_MEX_FILE
+#define MAX_OPEN_STORES 32
+#define MAX_FILENAME_LENGTH 1024
+
+/* The mapped stores and the file size and modification time when mapped. */
+typedef struct {
+    char fileName[MAX_FILENAME_LENGTH];
+    tsStore store;
+    struct stat fileStat;
+} openStore;
+static openStore openStores[MAX_OPEN_STORES];
+static int nOpenStores = 0;
+
+void writeCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void listCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void readCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void closeCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+const tsStore *getStore(const mxArray *fileNameArray);
+void closeStore(const int i);
+void closeAllStores(void);
+
+/* Gateway function. The first input is the command (see above). */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char command[16];
+
+    if (nrhs < 1 || !mxIsChar(prhs[0]))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "The first input must be the command 'write', 'list', 'read' or 'close'.");
+    mexAtExit(closeAllStores);
+
+    mxGetString(prhs[0], command, sizeof(command));
+    if (strcmp(command, "write") == 0)
+        writeCommand(nlhs, plhs, nrhs, prhs);
+    else if (strcmp(command, "list") == 0)
+        listCommand(nlhs, plhs, nrhs, prhs);
+    else if (strcmp(command, "read") == 0)
+        readCommand(nlhs, plhs, nrhs, prhs);
+    else if (strcmp(command, "close") == 0)
+        closeCommand(nlhs, plhs, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "Unknown command: %s", command);
+}
+
+void writeCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char fileName[MAX_FILENAME_LENGTH], message[TSSTORE_MESSAGE_LENGTH];
+    const char **sites, **variables;
+    const double **time, **values;
+    size_t *nValues;
+    int i, nSeries, isWritten;
+    mxArray *data;
+
+    if (nrhs != 5 || !mxIsChar(prhs[1]) || !mxIsCell(prhs[2]) || !mxIsCell(prhs[3]) || !mxIsCell(prhs[4]))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "The inputs must be 'write', fileName, sites, variables and data, where sites, variables and data are cell arrays.");
+    nSeries = (int) mxGetNumberOfElements(prhs[2]);
+    if ((int) mxGetNumberOfElements(prhs[3]) != nSeries || (int) mxGetNumberOfElements(prhs[4]) != nSeries)
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "sites, variables and data must have the same number of elements.");
+    mxGetString(prhs[1], fileName, sizeof(fileName));
+
+    /* Get pointers to the inputs. Note, if an error occurs then MATLAB frees
+     * the memory allocated by mxCalloc() and mxArrayToString(). */
+    sites = (const char **) mxCalloc(nSeries > 0 ? nSeries : 1, sizeof(char *));
+    variables = (const char **) mxCalloc(nSeries > 0 ? nSeries : 1, sizeof(char *));
+    time = (const double **) mxCalloc(nSeries > 0 ? nSeries : 1, sizeof(double *));
+    values = (const double **) mxCalloc(nSeries > 0 ? nSeries : 1, sizeof(double *));
+    nValues = (size_t *) mxCalloc(nSeries > 0 ? nSeries : 1, sizeof(size_t));
+    for (i = 0; i < nSeries; i++) {
+        if (mxGetCell(prhs[2], i) == NULL || !mxIsChar(mxGetCell(prhs[2], i))
+        || mxGetCell(prhs[3], i) == NULL || !mxIsChar(mxGetCell(prhs[3], i)))
+            mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                    "sites and variables must be cell arrays of strings.");
+        data = mxGetCell(prhs[4], i);
+        if (data == NULL || !mxIsDouble(data) || (mxGetN(data) != 2 && mxGetNumberOfElements(data) > 0))
+            mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                    "Each element of data must be an Nx2 double matrix of [time, value] (see series %d).", i + 1);
+        sites[i] = mxArrayToString(mxGetCell(prhs[2], i));
+        variables[i] = mxArrayToString(mxGetCell(prhs[3], i));
+        nValues[i] = mxGetM(data);
+        time[i] = mxGetPr(data);
+        values[i] = mxGetPr(data) + nValues[i];
+    }
+
+    /* Unmap the store if it was mapped by this process. */
+    for (i = nOpenStores - 1; i >= 0; i--)
+        if (strcmp(openStores[i].fileName, fileName) == 0)
+            closeStore(i);
+
+    isWritten = tsStore_write(fileName, nSeries, sites, variables, nValues, time, values, message);
+    for (i = 0; i < nSeries; i++) {
+        mxFree((void *) sites[i]);
+        mxFree((void *) variables[i]);
+    }
+    mxFree((void *) sites);
+    mxFree((void *) variables);
+    mxFree((void *) time);
+    mxFree((void *) values);
+    mxFree(nValues);
+    if (!isWritten)
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:fileError", "%s", message);
+}
+
+void listCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const char *fieldNames[] = {"site", "variable", "nValues", "startTime", "endTime"};
+    const tsStore *store;
+    const double *time;
+    size_t n;
+    int i;
+
+    if (nrhs != 2 || !mxIsChar(prhs[1]))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "The inputs must be 'list' and fileName.");
+    store = getStore(prhs[1]);
+
+    plhs[0] = mxCreateStructMatrix(store->nSeries, 1, 5, fieldNames);
+    for (i = 0; i < store->nSeries; i++) {
+        n = tsStore_length(store, i);
+        time = tsStore_time(store, i);
+        mxSetField(plhs[0], i, "site", mxCreateString(store->entries[i].site));
+        mxSetField(plhs[0], i, "variable", mxCreateString(store->entries[i].variable));
+        mxSetField(plhs[0], i, "nValues", mxCreateDoubleScalar((double) n));
+        mxSetField(plhs[0], i, "startTime", mxCreateDoubleScalar(n > 0 ? time[0] : mxGetNaN()));
+        mxSetField(plhs[0], i, "endTime", mxCreateDoubleScalar(n > 0 ? time[n-1] : mxGetNaN()));
+    }
+}
+
+void readCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char site[TSSTORE_SITE_LENGTH], variable[TSSTORE_VARIABLE_LENGTH];
+    const tsStore *store;
+    const mxArray *variableArray;
+    int j, nVariables, *index;
+    size_t n;
+    double *data;
+
+    if (nrhs != 4 || !mxIsChar(prhs[1]) || !mxIsChar(prhs[2]) || (!mxIsChar(prhs[3]) && !mxIsCell(prhs[3])))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "The inputs must be 'read', fileName, site and variable (a string or cell array of strings).");
+    store = getStore(prhs[1]);
+    mxGetString(prhs[2], site, sizeof(site));
+
+    /* Find the series of each variable. */
+    nVariables = mxIsChar(prhs[3]) ? 1 : (int) mxGetNumberOfElements(prhs[3]);
+    index = (int *) mxCalloc(nVariables > 0 ? nVariables : 1, sizeof(int));
+    for (j = 0; j < nVariables; j++) {
+        variableArray = mxIsChar(prhs[3]) ? prhs[3] : mxGetCell(prhs[3], j);
+        if (variableArray == NULL || !mxIsChar(variableArray))
+            mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                    "The variables must be a cell array of strings.");
+        mxGetString(variableArray, variable, sizeof(variable));
+        index[j] = tsStore_find(store, site, variable);
+        if (index[j] < 0)
+            mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                    "The store does not contain the variable %s for the site %s.", variable, site);
+        if (j > 0 && (tsStore_length(store, index[j]) != tsStore_length(store, index[0])
+        || (tsStore_time(store, index[j]) != tsStore_time(store, index[0])
+        && memcmp(tsStore_time(store, index[j]), tsStore_time(store, index[0]), tsStore_length(store, index[0]) * sizeof(double)) != 0)))
+            mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                    "The variables of site %s do not have the same times.", site);
+    }
+
+    /* Copy the columns. */
+    n = nVariables > 0 ? tsStore_length(store, index[0]) : 0;
+    plhs[0] = mxCreateDoubleMatrix(n, nVariables + 1, mxREAL);
+    data = mxGetPr(plhs[0]);
+    if (nVariables > 0 && n > 0) {
+        memcpy(data, tsStore_time(store, index[0]), n * sizeof(double));
+        for (j = 0; j < nVariables; j++)
+            memcpy(data + (j + 1) * n, tsStore_values(store, index[j]), n * sizeof(double));
+    }
+    mxFree(index);
+}
+
+void closeCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char fileName[MAX_FILENAME_LENGTH];
+    int i;
+
+    if (nrhs < 2) {
+        closeAllStores();
+        return;
+    }
+    if (!mxIsChar(prhs[1]))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:invalidInput",
+                "The inputs must be 'close' and, optionally, fileName.");
+    mxGetString(prhs[1], fileName, sizeof(fileName));
+    for (i = nOpenStores - 1; i >= 0; i--)
+        if (strcmp(openStores[i].fileName, fileName) == 0)
+            closeStore(i);
+}
+
+/* Get the mapped store, mapping it if it is not mapped or if the file has
+ * changed since it was mapped. */
+const tsStore *getStore(const mxArray *fileNameArray)
+{
+    char fileName[MAX_FILENAME_LENGTH], message[TSSTORE_MESSAGE_LENGTH];
+    struct stat fileStat;
+    int i;
+
+    mxGetString(fileNameArray, fileName, sizeof(fileName));
+    if (stat(fileName, &fileStat) != 0)
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:fileError",
+                "The store does not exist: %s", fileName);
+
+    for (i = 0; i < nOpenStores; i++) {
+        if (strcmp(openStores[i].fileName, fileName) == 0) {
+            if (fileStat.st_size == openStores[i].fileStat.st_size && fileStat.st_mtime == openStores[i].fileStat.st_mtime
+            && fileStat.st_ino == openStores[i].fileStat.st_ino)
+                return &openStores[i].store;
+            closeStore(i);
+            break;
+        }
+    }
+
+    if (nOpenStores == MAX_OPEN_STORES)
+        closeStore(0);
+
+    i = nOpenStores;
+    if (!tsStore_open(fileName, &openStores[i].store, message))
+        mexErrMsgIdAndTxt("HydroSight:timeSeriesStore:fileError", "%s", message);
+    strcpy(openStores[i].fileName, fileName);
+    openStores[i].fileStat = fileStat;
+    nOpenStores++;
+    return &openStores[i].store;
+}
+
+void closeStore(const int i)
+{
+    tsStore_close(&openStores[i].store);
+    memmove(openStores + i, openStores + i + 1, (nOpenStores - i - 1) * sizeof(openStore));
+    nOpenStores--;
+}
+
+void closeAllStores(void)
+{
+    while (nOpenStores > 0)
+        closeStore(nOpenStores - 1);
+}
+#endif
+
+/* Series key used to sort the directory. */
+typedef struct {
+    const char *site;
+    const char *variable;
+    int index;
+} seriesKey;
+
+static int compareKeys(const char *site1, const char *variable1, const char *site2, const char *variable2)
+{
+    const int c = strcmp(site1, site2);
+    return c != 0 ? c : strcmp(variable1, variable2);
+}
+
+static int compareSeriesKeys(const void *a, const void *b)
+{
+    const seriesKey *key1 = (const seriesKey *) a, *key2 = (const seriesKey *) b;
+    return compareKeys(key1->site, key1->variable, key2->site, key2->variable);
+}
+
+static uint64_t alignOffset(const uint64_t offset)
+{
+    return (offset + TSSTORE_ALIGNMENT - 1) / TSSTORE_ALIGNMENT * TSSTORE_ALIGNMENT;
+}
+
+/* Check the header and directory of the mapped file. */
+static int validateStore(tsStore *store, const char *fileName, char *message)
+{
+    const tsStoreHeader *header = (const tsStoreHeader *) store->base;
+    const tsStoreEntry *entry;
+    int i;
+
+    if (store->size < sizeof(tsStoreHeader) || memcmp(header->magic, TSSTORE_MAGIC, 8) != 0) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The file is not a time series store: %s", fileName);
+        return 0;
+    }
+    if (header->version != TSSTORE_VERSION || header->byteOrderMark != TSSTORE_BYTE_ORDER_MARK) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store version or byte order is not supported: %s", fileName);
+        return 0;
+    }
+    if (header->directoryOffset % sizeof(double) != 0 || header->directoryOffset > store->size
+    || header->nSeries > (store->size - header->directoryOffset) / sizeof(tsStoreEntry)) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store directory is corrupt: %s", fileName);
+        return 0;
+    }
+
+    store->nSeries = (int) header->nSeries;
+    store->entries = (const tsStoreEntry *) (store->base + header->directoryOffset);
+    for (i = 0; i < store->nSeries; i++) {
+        entry = store->entries + i;
+        if (memchr(entry->site, '\0', TSSTORE_SITE_LENGTH) == NULL || memchr(entry->variable, '\0', TSSTORE_VARIABLE_LENGTH) == NULL
+        || entry->timeOffset % sizeof(double) != 0 || entry->valueOffset % sizeof(double) != 0
+        || entry->nValues > store->size / sizeof(double)
+        || entry->timeOffset > store->size - entry->nValues * sizeof(double)
+        || entry->valueOffset > store->size - entry->nValues * sizeof(double)
+        || (i > 0 && compareKeys(entry[-1].site, entry[-1].variable, entry->site, entry->variable) >= 0)) {
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "Series %d of the store is corrupt: %s", i + 1, fileName);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int tsStore_open(const char *fileName, tsStore *store, char *message)
+{
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+#else
+    struct stat fileStat;
+#endif
+
+    memset(store, 0, sizeof(tsStore));
+#ifdef _WIN32
+    store->file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (store->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(store->file, &fileSize)) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be opened: %s", fileName);
+        if (store->file != INVALID_HANDLE_VALUE)
+            CloseHandle(store->file);
+        store->file = NULL;
+        return 0;
+    }
+    store->size = (size_t) fileSize.QuadPart;
+    if (store->size >= sizeof(tsStoreHeader)) {
+        store->mapping = CreateFileMappingA(store->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (store->mapping != NULL)
+            store->base = (const char *) MapViewOfFile(store->mapping, FILE_MAP_READ, 0, 0, 0);
+        if (store->base == NULL) {
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be mapped: %s", fileName);
+            tsStore_close(store);
+            return 0;
+        }
+    }
+#else
+    store->fd = open(fileName, O_RDONLY);
+    if (store->fd < 0 || fstat(store->fd, &fileStat) != 0) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be opened: %s", fileName);
+        if (store->fd >= 0)
+            close(store->fd);
+        store->fd = -1;
+        return 0;
+    }
+    store->size = (size_t) fileStat.st_size;
+    if (store->size >= sizeof(tsStoreHeader)) {
+        store->base = (const char *) mmap(NULL, store->size, PROT_READ, MAP_SHARED, store->fd, 0);
+        if (store->base == (const char *) MAP_FAILED) {
+            store->base = NULL;
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be mapped: %s", fileName);
+            tsStore_close(store);
+            return 0;
+        }
+    }
+#endif
+
+    if (store->base == NULL || !validateStore(store, fileName, message)) {
+        if (store->base == NULL)
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "The file is not a time series store: %s", fileName);
+        tsStore_close(store);
+        return 0;
+    }
+    return 1;
+}
+
+void tsStore_close(tsStore *store)
+{
+#ifdef _WIN32
+    if (store->base != NULL)
+        UnmapViewOfFile(store->base);
+    if (store->mapping != NULL)
+        CloseHandle(store->mapping);
+    if (store->file != NULL)
+        CloseHandle(store->file);
+    store->mapping = NULL;
+    store->file = NULL;
+#else
+    if (store->base != NULL)
+        munmap((void *) store->base, store->size);
+    if (store->fd >= 0)
+        close(store->fd);
+    store->fd = -1;
+#endif
+    store->base = NULL;
+    store->size = 0;
+    store->nSeries = 0;
+    store->entries = NULL;
+}
+
+int tsStore_find(const tsStore *store, const char *site, const char *variable)
+{
+    int lower = 0, upper = store->nSeries - 1, middle, c;
+
+    while (lower <= upper) {
+        middle = lower + (upper - lower) / 2;
+        c = compareKeys(store->entries[middle].site, store->entries[middle].variable, site, variable);
+        if (c == 0)
+            return middle;
+        else if (c < 0)
+            lower = middle + 1;
+        else
+            upper = middle - 1;
+    }
+    return -1;
+}
+
+size_t tsStore_length(const tsStore *store, const int i)
+{
+    return (size_t) store->entries[i].nValues;
+}
+
+const double *tsStore_time(const tsStore *store, const int i)
+{
+    return (const double *) (store->base + store->entries[i].timeOffset);
+}
+
+const double *tsStore_values(const tsStore *store, const int i)
+{
+    return (const double *) (store->base + store->entries[i].valueOffset);
+}
+
+/* Write zero padding up to the offset. */
+static int writePadding(FILE *fid, uint64_t *offset, const uint64_t newOffset)
+{
+    static const char zeros[TSSTORE_ALIGNMENT] = {0};
+    const size_t n = (size_t) (newOffset - *offset);
+    *offset = newOffset;
+    return n == 0 || fwrite(zeros, 1, n, fid) == n;
+}
+
+int tsStore_write(const char *fileName, const int nSeries, const char **sites, const char **variables,
+        const size_t *nValues, const double **time, const double **values, char *message)
+{
+    tsStoreHeader header;
+    tsStoreEntry *entries = NULL;
+    seriesKey *keys = NULL;
+    char *tempFileName = NULL;
+    FILE *fid = NULL;
+    uint64_t offset;
+    int i, j, k, isOK = 0;
+
+    /* Sort the series and check the keys. */
+    keys = (seriesKey *) malloc((nSeries > 0 ? nSeries : 1) * sizeof(seriesKey));
+    entries = (tsStoreEntry *) calloc(nSeries > 0 ? nSeries : 1, sizeof(tsStoreEntry));
+    tempFileName = (char *) malloc(strlen(fileName) + 5);
+    for (i = 0; i < nSeries; i++) {
+        if (strlen(sites[i]) == 0 || strlen(sites[i]) >= TSSTORE_SITE_LENGTH
+        || strlen(variables[i]) == 0 || strlen(variables[i]) >= TSSTORE_VARIABLE_LENGTH) {
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "Site names must be 1 to %d characters and variable names 1 to %d characters (see series %d).",
+                    TSSTORE_SITE_LENGTH - 1, TSSTORE_VARIABLE_LENGTH - 1, i + 1);
+            goto cleanup;
+        }
+        keys[i].site = sites[i];
+        keys[i].variable = variables[i];
+        keys[i].index = i;
+    }
+    qsort(keys, nSeries, sizeof(seriesKey), compareSeriesKeys);
+    for (i = 1; i < nSeries; i++) {
+        if (compareSeriesKeys(keys + i - 1, keys + i) == 0) {
+            snprintf(message, TSSTORE_MESSAGE_LENGTH, "The site %s has more than one series of the variable %s.",
+                    keys[i].site, keys[i].variable);
+            goto cleanup;
+        }
+    }
+
+    /* Derive the layout. A time column identical to that of a prior series
+     * of the same site is not stored again. */
+    offset = alignOffset(sizeof(tsStoreHeader));
+    for (i = 0; i < nSeries; i++) {
+        k = keys[i].index;
+        strcpy(entries[i].site, sites[k]);
+        strcpy(entries[i].variable, variables[k]);
+        entries[i].nValues = nValues[k];
+        entries[i].timeOffset = 0;
+        for (j = i - 1; j >= 0 && strcmp(entries[j].site, entries[i].site) == 0; j--) {
+            if (entries[j].nValues == nValues[k]
+            && memcmp(time[keys[j].index], time[k], nValues[k] * sizeof(double)) == 0) {
+                entries[i].timeOffset = entries[j].timeOffset;
+                break;
+            }
+        }
+        if (entries[i].timeOffset == 0) {
+            entries[i].timeOffset = offset;
+            offset = alignOffset(offset + nValues[k] * sizeof(double));
+        }
+        entries[i].valueOffset = offset;
+        offset = alignOffset(offset + nValues[k] * sizeof(double));
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TSSTORE_MAGIC, 8);
+    header.version = TSSTORE_VERSION;
+    header.byteOrderMark = TSSTORE_BYTE_ORDER_MARK;
+    header.nSeries = (uint64_t) nSeries;
+    header.directoryOffset = offset;
+
+    /* Write the store to a temporary file, in order of the offsets, and then
+     * replace the store. */
+    sprintf(tempFileName, "%s.tmp", fileName);
+    fid = fopen(tempFileName, "wb");
+    if (fid == NULL) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be created: %s", tempFileName);
+        goto cleanup;
+    }
+    offset = sizeof(tsStoreHeader);
+    isOK = fwrite(&header, sizeof(header), 1, fid) == 1;
+    for (i = 0; i < nSeries && isOK; i++) {
+        k = keys[i].index;
+        if (entries[i].timeOffset >= offset) {
+            isOK = writePadding(fid, &offset, entries[i].timeOffset)
+                    && fwrite(time[k], sizeof(double), nValues[k], fid) == nValues[k];
+            offset += nValues[k] * sizeof(double);
+        }
+        isOK = isOK && writePadding(fid, &offset, entries[i].valueOffset)
+                && fwrite(values[k], sizeof(double), nValues[k], fid) == nValues[k];
+        offset += nValues[k] * sizeof(double);
+    }
+    isOK = isOK && writePadding(fid, &offset, header.directoryOffset)
+            && fwrite(entries, sizeof(tsStoreEntry), nSeries, fid) == (size_t) nSeries;
+    isOK = fclose(fid) == 0 && isOK;
+    if (!isOK) {
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be written: %s", tempFileName);
+        remove(tempFileName);
+        goto cleanup;
+    }
+
+#ifdef _WIN32
+    if (!MoveFileExA(tempFileName, fileName, MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (rename(tempFileName, fileName) != 0) {
+#endif
+        snprintf(message, TSSTORE_MESSAGE_LENGTH, "The store could not be replaced (is it open by another process?): %s", fileName);
+        remove(tempFileName);
+        isOK = 0;
+    }
+
+cleanup:
+    free(keys);
+    free(entries);
+    free(tempFileName);
+    return isOK;
+}
@@ -0,0 +1,530 @@
+/* benchmarkKernels - native benchmark and performance regression test of the MEX kernels.
+ *
+ * The numerical cores of doIRFconvolution.c, forcingTransform_soilMoisture.c
+ * and doExpSmoothing.c are linked without MATLAB (ie MATLAB_MEX_FILE is not
+ * defined) and run on deterministic synthetic workloads of 10, 50 and 100
+ * years of daily forcing. For each workload the following are reported:
+ *   - the run time per output point (ns), taken as the fastest of repeated runs;
+ *   - the number of Newton-Raphson and bisection iterations (soil model only);
+ *   - the effective memory bandwidth (GB/s), estimated from the bytes of the
+ *     input and output vectors touched by the kernel;
+ *   - a checksum of the outputs.
+ *
+ * If a baseline file is input then each workload is compared against it and
+ * the program exits with a non-zero status if a checksum or iteration count
+ * differs, or if the run time exceeds the baseline by more than the time
+ * tolerance. Note, the run times within the baseline are specific to the
+ * computer used to create it and so it should be re-created (using --update)
+ * on the computer used to test new builds, and before any change to the
+ * kernels is made.
+ *
+ * Build (from the HydroSight root folder):
+      gcc -O2 -fopenmp -o benchmarkKernels testing/benchmark/benchmarkKernels.c \
+          algorithms/models/TransferNoise/doIRFconvolution.c \
+          algorithms/models/TransferNoise/ForcingTransformation/forcingTransform_soilMoisture.c \
+          algorithms/models/ExpSmooth/doExpSmoothing.c -lm
+ *
+ * To compare compiler settings (eg -Ofast, as discussed in Build_C_code.m)
+ * build again with the alternate flags and compare against the same baseline.
+ *
+ * Usage:
+      ./benchmarkKernels [--baseline file] [--update] [--time-tolerance 0.25]
+                         [--result-tolerance 1e-9] [--filter text] [--min-time 0.1]
+ *
+ *   --baseline          Baseline file to compare against (or to write with --update).
+ *   --update            Write the results to the baseline file.
+ *   --time-tolerance    Allowable fractional increase in the run time (default 0.25).
+ *   --result-tolerance  Allowable relative change in the checksum (default 1e-9).
+ *   --filter            Only run workloads whose name contains the text.
+ *   --min-time          Minimum total run time (s) of the repeats of each workload (default 0.1).
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#ifdef _WIN32
+#include "windows.h"
+#endif
+#include "../../algorithms/hydroSightKernels.h"
+
+#define MAX_WORKLOADS 128
+#define MAX_NAME_LENGTH 64
+#define MIN_REPEATS 3
+#define DAYS_PER_YEAR 365
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    double nsPerPoint;
+    double bandwidth;
+    double nIterations;
+    double nIterations_bisect;
+    double checksum;
+} benchmarkResult;
+
+/* Synthetic daily climate. */
+typedef struct {
+    int nDays;
+    double *precip, *et, *temp;
+} climateData;
+
+static unsigned long long randomState;
+
+/* Deterministic uniform random numbers in (0,1) using a 64 bit LCG. */
+static double randUniform(void)
+{
+    randomState = randomState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((double) (randomState >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+static double randNormal(void)
+{
+    return sqrt(-2.0 * log(randUniform())) * cos(6.283185307179586 * randUniform());
+}
+
+static double getTime(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1.0e-9 * (double) t.tv_nsec;
+#endif
+}
+
+/* Create seasonal daily rainfall, potential ET and temperature. The rainfall
+ * occurrence is seasonal and the depths are exponentially distributed. For
+ * the snow climate, the mean temperature is lowered so that winter
+ * rainfall falls as snow. The same seed always gives the same climate. */
+static climateData createClimate(const int nYears, const int hasSnow, const unsigned long long seed)
+{
+    climateData climate;
+    int i;
+    double season, pWet;
+
+    randomState = seed;
+    climate.nDays = nYears * DAYS_PER_YEAR;
+    climate.precip = (double *) malloc(climate.nDays * sizeof(double));
+    climate.et = (double *) malloc(climate.nDays * sizeof(double));
+    climate.temp = (double *) malloc(climate.nDays * sizeof(double));
+    for (i = 0; i < climate.nDays; i++) {
+        season = sin(6.283185307179586 * (double) i / DAYS_PER_YEAR);
+        pWet = 0.3 - 0.15 * season;
+        climate.precip[i] = randUniform() < pWet ? -6.0 * log(randUniform()) : 0.0;
+        climate.et[i] = 3.0 + 2.5 * season;
+        climate.temp[i] = (hasSnow ? 2.0 : 15.0) + 10.0 * season + 3.0 * randNormal();
+    }
+    return climate;
+}
+
+static void freeClimate(climateData *climate)
+{
+    free(climate->precip);
+    free(climate->et);
+    free(climate->temp);
+}
+
+/* Soil moisture model workload. If stormDepth is >0 then a storm of this
+ * depth is added to the rainfall once each year. With a large beta, the
+ * Newton-Raphson solution for the storm days leaves the soil capacity and so
+ * the bisection solver is required. */
+static benchmarkResult benchmarkSoilMoisture(const char *name, const climateData *climate, const double alpha,
+        const double beta, const double eps, const int hasSnow, const double stormDepth, const double minTime)
+{
+    benchmarkResult result;
+    const double S_cap = 150.0, Ksat = 5.0, gamma = 1.0;
+    const double DDF = hasSnow ? 3.0 : NAN, melt_threshold = hasSnow ? 0.0 : NAN;
+    const int nDays = climate->nDays;
+    double *precip = (double *) malloc(nDays * sizeof(double));
+    double *soilMoisture = (double *) malloc(nDays * sizeof(double));
+    double t, tMin = 1.0e300, tTotal = 0.0, checksum = 0.0;
+    unsigned int nIterations = 0, nIterations_bisect = 0;
+    int i, nRepeats = 0;
+
+    while (nRepeats < MIN_REPEATS || tTotal < minTime) {
+        /* Note, the precip is updated in place when there is snow and so
+         * is reset prior to each run. */
+        memcpy(precip, climate->precip, nDays * sizeof(double));
+        if (stormDepth > 0.0)
+            for (i = DAYS_PER_YEAR/4; i < nDays; i += DAYS_PER_YEAR)
+                precip[i] += stormDepth;
+        t = getTime();
+        soilMoistureModel(nDays, 0.5*S_cap, precip, climate->et, climate->temp, S_cap, Ksat, alpha, beta, gamma, eps,
+                DDF, melt_threshold, soilMoisture, &nIterations, &nIterations_bisect, NULL, NULL);
+        t = getTime() - t;
+        tMin = t < tMin ? t : tMin;
+        tTotal += t;
+        nRepeats++;
+    }
+    for (i = 0; i < nDays; i++)
+        checksum += soilMoisture[i];
+
+    strncpy(result.name, name, MAX_NAME_LENGTH - 1);
+    result.name[MAX_NAME_LENGTH - 1] = '\0';
+    result.nsPerPoint = 1.0e9 * tMin / nDays;
+    /* Read precip, et and temp and write the soil moisture. */
+    result.bandwidth = 4.0 * sizeof(double) * nDays / tMin / 1.0e9;
+    result.nIterations = nIterations;
+    result.nIterations_bisect = nIterations_bisect;
+    result.checksum = checksum;
+
+    free(precip);
+    free(soilMoisture);
+    return result;
+}
+
+/* Convolution workload. The response function is exponential and theta is
+ * set up as per model_TFN.get_h_star(), ie theta is for tor = ntor-1 to 0
+ * and, for each output time point, the forcing from the first day to the
+ * time point is convolved. The output time points are weekly, starting after
+ * nYearsHistory years, and so the history length (ie the maximum tor) 
+ * increases from nYearsHistory to the record length. Note, trapazoidal() 
+ * reads one element prior to the forcing and two prior to theta and so both
+ * are padded with zeros. mode is 0 for the per point kernels, 1 for the 
+ * streaming convolution and 2 for the recursive convolution. */
+static benchmarkResult benchmarkConvolution(const char *name, const climateData *climate, const int nYearsHistory,
+        const int isForcingAnIntegral, const int mode, const double minTime)
+{
+    benchmarkResult result;
+    const int nDays = climate->nDays, ntor = nDays, theta_indexes_end = ntor + 1;
+    const double A = 0.01, tau = 90.0;
+    const double intTheta_0to1 = A * tau * (1.0 - exp(-1.0/tau));
+    const double terms[3] = {A, 1.0/tau, 0.0};
+    int i, iDay, nIndex, nRepeats = 0;
+    double *theta, *forcing, *theta_padded, *forcing_padded, *theta_indexes_start, *intTheta_upperTail, *h_star, forcingMean = 0.0;
+    double t, tMin = 1.0e300, tTotal = 0.0, checksum = 0.0, nBytes = 0.0;
+
+    nIndex = 0;
+    for (iDay = nYearsHistory * DAYS_PER_YEAR - 1; iDay < nDays; iDay += 7)
+        nIndex++;
+
+    theta_padded = (double *) calloc(ntor + 2, sizeof(double));
+    forcing_padded = (double *) calloc(nDays + 2, sizeof(double));
+    theta = theta_padded + 2;
+    forcing = forcing_padded + 2;
+    theta_indexes_start = (double *) malloc(nIndex * sizeof(double));
+    intTheta_upperTail = (double *) malloc(nIndex * sizeof(double));
+    h_star = (double *) malloc(nIndex * sizeof(double));
+
+    for (i = 0; i < ntor; i++)
+        theta[i] = A * exp(-(double) (ntor - 1 - i)/tau);
+    for (i = 0; i < nDays; i++) {
+        forcing[i] = climate->precip[i];
+        forcingMean += forcing[i];
+    }
+    forcingMean /= nDays;
+
+    i = 0;
+    for (iDay = nYearsHistory * DAYS_PER_YEAR - 1; iDay < nDays; iDay += 7) {
+        theta_indexes_start[i] = ntor - iDay;
+        intTheta_upperTail[i] = A * tau * exp(-(double) (ntor - theta_indexes_start[i])/tau);
+        /* Read theta and the forcing from the first day to the time point. */
+        nBytes += 2.0 * sizeof(double) * (theta_indexes_end - theta_indexes_start[i]);
+        i++;
+    }
+    
+    /* The recursive convolution reads theta (to check the terms) and the 
+     * forcing once. */
+    if (mode == 2)
+        nBytes = sizeof(double) * ((double) ntor + nDays + nIndex);
+
+    while (nRepeats < MIN_REPEATS || tTotal < minTime) {
+        t = getTime();
+        if (mode == 2) {
+            if (!convolution_recursive(1, terms, theta, ntor, theta_indexes_start, nIndex, theta_indexes_end, forcing, nDays,
+                    isForcingAnIntegral, intTheta_0to1, intTheta_upperTail, forcingMean, h_star))
+                fprintf(stderr, "The recursive convolution was not undertaken: %s\n", name);
+        }
+        else if (mode == 1)
+            convolution_streaming(theta, theta_indexes_start, nIndex, theta_indexes_end, forcing, isForcingAnIntegral,
+                    intTheta_0to1, intTheta_upperTail, forcingMean, 64, h_star, ntor, 0, NULL, NULL, NULL, NULL);
+        else if (isForcingAnIntegral == 0)
+            for (i = 0; i < nIndex; i++)
+                h_star[i] = Simpsons_ExtendedRule((int) theta_indexes_start[i], theta_indexes_end,
+                        theta + (int) theta_indexes_start[i] - 1, forcing, &intTheta_0to1);
+        else
+            for (i = 0; i < nIndex; i++)
+                h_star[i] = trapazoidal((int) theta_indexes_start[i], theta_indexes_end,
+                        theta + (int) theta_indexes_start[i] - 1, forcing, &intTheta_0to1);
+        t = getTime() - t;
+        tMin = t < tMin ? t : tMin;
+        tTotal += t;
+        nRepeats++;
+    }
+    for (i = 0; i < nIndex; i++)
+        checksum += h_star[i];
+
+    strncpy(result.name, name, MAX_NAME_LENGTH - 1);
+    result.name[MAX_NAME_LENGTH - 1] = '\0';
+    result.nsPerPoint = 1.0e9 * tMin / nIndex;
+    result.bandwidth = nBytes / tMin / 1.0e9;
+    result.nIterations = 0;
+    result.nIterations_bisect = 0;
+    result.checksum = checksum;
+
+    free(theta_padded);
+    free(forcing_padded);
+    free(theta_indexes_start);
+    free(intTheta_upperTail);
+    free(h_star);
+    return result;
+}
+
+/* Exponential smoothing workload. Heads are observed at irregular
+ * intervals of 1 to 30 days and the model is also evaluated daily between
+ * the observations. */
+static benchmarkResult benchmarkExpSmoothing(const char *name, const int nYears, const double alpha, const double gamma,
+        const double minTime)
+{
+    benchmarkResult result;
+    const int nPoints = nYears * DAYS_PER_YEAR;
+    double *time_points = (double *) malloc(nPoints * sizeof(double));
+    double *h_obs = (double *) malloc(nPoints * sizeof(double));
+    double *isObsTimePoint = (double *) malloc(nPoints * sizeof(double));
+    double *h_ar = (double *) malloc(nPoints * sizeof(double));
+    double *h_forecast = (double *) malloc(nPoints * sizeof(double));
+    double t, tMin = 1.0e300, tTotal = 0.0, checksum = 0.0, h_mean = 0.0, q = 0.0;
+    int i, nObs = 0, nextObs = 0, nRepeats = 0;
+
+    randomState = 42;
+    for (i = 0; i < nPoints; i++) {
+        time_points[i] = 730000.0 + i;
+        isObsTimePoint[i] = 0.0;
+        if (i == nextObs) {
+            isObsTimePoint[i] = 1.0;
+            h_obs[nObs] = 100.0 + 2.0 * sin(6.283185307179586 * i / DAYS_PER_YEAR) + 0.002 * i + 0.2 * randNormal();
+            h_mean += h_obs[nObs];
+            nObs++;
+            nextObs += 1 + (int) (30.0 * randUniform());
+        }
+    }
+    h_mean /= nObs;
+    q = (double) (nPoints - 1) / (nObs - 1) / DAYS_PER_YEAR;
+
+    while (nRepeats < MIN_REPEATS || tTotal < minTime) {
+        t = getTime();
+        expSmoothing(nPoints, time_points, h_obs, isObsTimePoint, h_mean, alpha, gamma, q, h_obs[0], 0.0, h_ar, h_forecast);
+        t = getTime() - t;
+        tMin = t < tMin ? t : tMin;
+        tTotal += t;
+        nRepeats++;
+    }
+    for (i = 0; i < nPoints; i++)
+        checksum += h_ar[i] + h_forecast[i];
+
+    strncpy(result.name, name, MAX_NAME_LENGTH - 1);
+    result.name[MAX_NAME_LENGTH - 1] = '\0';
+    result.nsPerPoint = 1.0e9 * tMin / nPoints;
+    /* Read the time points, the observation flags and, at most, one
+     * observation and write two outputs. */
+    result.bandwidth = 5.0 * sizeof(double) * nPoints / tMin / 1.0e9;
+    result.nIterations = 0;
+    result.nIterations_bisect = 0;
+    result.checksum = checksum;
+
+    free(time_points);
+    free(h_obs);
+    free(isObsTimePoint);
+    free(h_ar);
+    free(h_forecast);
+    return result;
+}
+
+static int readBaseline(const char *fileName, benchmarkResult *baseline)
+{
+    char line[512];
+    int nBaseline = 0;
+    FILE *fid = fopen(fileName, "r");
+    if (fid == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), fid) != NULL && nBaseline < MAX_WORKLOADS) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+            continue;
+        if (sscanf(line, "%63s %lf %lf %lf %lf %lf", baseline[nBaseline].name, &baseline[nBaseline].nsPerPoint,
+                &baseline[nBaseline].bandwidth, &baseline[nBaseline].nIterations, &baseline[nBaseline].nIterations_bisect,
+                &baseline[nBaseline].checksum) == 6)
+            nBaseline++;
+    }
+    fclose(fid);
+    return nBaseline;
+}
+
+static int writeBaseline(const char *fileName, const benchmarkResult *results, const int nResults)
+{
+    int i;
+    FILE *fid = fopen(fileName, "w");
+    if (fid == NULL)
+        return -1;
+    fprintf(fid, "# HydroSight native kernel benchmark baseline. Created using testing/benchmark/benchmarkKernels.c --update.\n");
+    fprintf(fid, "# Run times are specific to the computer used to create the baseline.\n");
+    fprintf(fid, "# name ns_per_point GB_per_s newton_iterations bisection_iterations checksum\n");
+    for (i = 0; i < nResults; i++)
+        fprintf(fid, "%s %.1f %.2f %.0f %.0f %.17g\n", results[i].name, results[i].nsPerPoint, results[i].bandwidth,
+                results[i].nIterations, results[i].nIterations_bisect, results[i].checksum);
+    fclose(fid);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    /* Workload settings */
+    const int nYears[] = {10, 50, 100};
+    const char *soilNames[] = {"alpha1_eps0", "alpha0.5_eps0", "alpha2.5_eps0.3", "alpha0.5_eps0_snow", "alpha0.5_beta50_storm"};
+    const double soilAlpha[] = {1.0, 0.5, 2.5, 0.5, 0.5}, soilBeta[] = {2.5, 2.5, 2.5, 2.5, 50.0};
+    const double soilEps[] = {0.0, 0.0, 0.3, 0.0, 0.0}, soilStorm[] = {0.0, 0.0, 0.0, 0.0, 500.0};
+    const int soilSnow[] = {0, 0, 0, 1, 0};
+    const char *convNames[] = {"simpson", "trapz", "simpson_streaming", "trapz_streaming", "simpson_recursive", "trapz_recursive"};
+    const int convIsIntegral[] = {0, 1, 0, 1, 0, 1}, convMode[] = {0, 0, 1, 1, 2, 2};
+    const double smoothAlpha[] = {0.1, 0.5}, smoothGamma[] = {0.01, 0.1};
+
+    /* Options */
+    const char *baselineFile = NULL, *filter = NULL;
+    int doUpdate = 0;
+    double timeTolerance = 0.25, resultTolerance = 1.0e-9, minTime = 0.1;
+
+    benchmarkResult results[MAX_WORKLOADS], baseline[MAX_WORKLOADS];
+    climateData climate, climateSnow;
+    char name[MAX_NAME_LENGTH];
+    int i, j, k, iYears, nResults = 0, nBaseline = 0, nFailed = 0, nHistory[2];
+    double change;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselineFile = argv[++i];
+        else if (strcmp(argv[i], "--update") == 0)
+            doUpdate = 1;
+        else if (strcmp(argv[i], "--time-tolerance") == 0 && i + 1 < argc)
+            timeTolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--result-tolerance") == 0 && i + 1 < argc)
+            resultTolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minTime = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (doUpdate && baselineFile == NULL) {
+        fprintf(stderr, "--update requires --baseline.\n");
+        return 2;
+    }
+
+    printf("%-44s %12s %9s %12s %12s %24s\n", "workload", "ns/point", "GB/s", "newton_its", "bisect_its", "checksum");
+    for (iYears = 0; iYears < 3; iYears++) {
+        climate = createClimate(nYears[iYears], 0, 1);
+        climateSnow = createClimate(nYears[iYears], 1, 1);
+
+        /* Soil moisture model */
+        for (j = 0; j < 5; j++) {
+            sprintf(name, "soilMoisture_%dy_%s", nYears[iYears], soilNames[j]);
+            if (filter != NULL && strstr(name, filter) == NULL)
+                continue;
+            results[nResults++] = benchmarkSoilMoisture(name, soilSnow[j] ? &climateSnow : &climate, soilAlpha[j], soilBeta[j],
+                    soilEps[j], soilSnow[j], soilStorm[j], minTime);
+            printf("%-44s %12.1f %9.2f %12.0f %12.0f %24.17g\n", results[nResults-1].name, results[nResults-1].nsPerPoint,
+                    results[nResults-1].bandwidth, results[nResults-1].nIterations, results[nResults-1].nIterations_bisect,
+                    results[nResults-1].checksum);
+        }
+
+        /* Convolution for a 1 year history and for half of the record */
+        nHistory[0] = 1;
+        nHistory[1] = nYears[iYears]/2;
+        for (k = 0; k < 2; k++) {
+            for (j = 0; j < 6; j++) {
+                sprintf(name, "convolution_%dy_tor%dy_%s", nYears[iYears], nHistory[k], convNames[j]);
+                if (filter != NULL && strstr(name, filter) == NULL)
+                    continue;
+                results[nResults++] = benchmarkConvolution(name, &climate, nHistory[k], convIsIntegral[j], convMode[j], minTime);
+                printf("%-44s %12.1f %9.2f %12.0f %12.0f %24.17g\n", results[nResults-1].name, results[nResults-1].nsPerPoint,
+                        results[nResults-1].bandwidth, results[nResults-1].nIterations, results[nResults-1].nIterations_bisect,
+                        results[nResults-1].checksum);
+            }
+        }
+
+        /* Exponential smoothing */
+        for (j = 0; j < 2; j++) {
+            sprintf(name, "expSmoothing_%dy_alpha%g_gamma%g", nYears[iYears], smoothAlpha[j], smoothGamma[j]);
+            if (filter != NULL && strstr(name, filter) == NULL)
+                continue;
+            results[nResults++] = benchmarkExpSmoothing(name, nYears[iYears], smoothAlpha[j], smoothGamma[j], minTime);
+            printf("%-44s %12.1f %9.2f %12.0f %12.0f %24.17g\n", results[nResults-1].name, results[nResults-1].nsPerPoint,
+                    results[nResults-1].bandwidth, results[nResults-1].nIterations, results[nResults-1].nIterations_bisect,
+                    results[nResults-1].checksum);
+        }
+
+        freeClimate(&climate);
+        freeClimate(&climateSnow);
+    }
+
+    if (baselineFile == NULL)
+        return 0;
+
+    if (doUpdate) {
+        if (writeBaseline(baselineFile, results, nResults) != 0) {
+            fprintf(stderr, "The baseline file could not be written: %s\n", baselineFile);
+            return 2;
+        }
+        printf("\nBaseline written to %s\n", baselineFile);
+        return 0;
+    }
+
+    /* Compare against the baseline. */
+    nBaseline = readBaseline(baselineFile, baseline);
+    if (nBaseline < 0) {
+        fprintf(stderr, "The baseline file could not be read: %s\n", baselineFile);
+        return 2;
+    }
+    printf("\nComparison with %s (time tolerance %g, result tolerance %g):\n", baselineFile, timeTolerance, resultTolerance);
+    for (i = 0; i < nResults; i++) {
+        for (j = 0; j < nBaseline; j++)
+            if (strcmp(results[i].name, baseline[j].name) == 0)
+                break;
+        if (j == nBaseline) {
+            printf("  %-44s not in baseline\n", results[i].name);
+            continue;
+        }
+
+        change = fabs(results[i].checksum - baseline[j].checksum) / fmax(fabs(baseline[j].checksum), 1.0e-300);
+        if (change > resultTolerance) {
+            printf("  %-44s FAILED: checksum %.17g differs from baseline %.17g\n", results[i].name, results[i].checksum, baseline[j].checksum);
+            nFailed++;
+        }
+        if (results[i].nIterations != baseline[j].nIterations || results[i].nIterations_bisect != baseline[j].nIterations_bisect) {
+            printf("  %-44s FAILED: iterations %.0f/%.0f differ from baseline %.0f/%.0f\n", results[i].name, results[i].nIterations,
+                    results[i].nIterations_bisect, baseline[j].nIterations, baseline[j].nIterations_bisect);
+            nFailed++;
+        }
+        change = results[i].nsPerPoint / baseline[j].nsPerPoint - 1.0;
+        if (change > timeTolerance) {
+            printf("  %-44s FAILED: %.1f ns/point is %.0f%% slower than baseline %.1f\n", results[i].name, results[i].nsPerPoint,
+                    100.0*change, baseline[j].nsPerPoint);
+            nFailed++;
+        }
+        else
+            printf("  %-44s %+.0f%%\n", results[i].name, 100.0*change);
+    }
+
+    if (nFailed > 0) {
+        printf("\n%d check(s) FAILED.\n", nFailed);
+        return 1;
+    }
+    printf("\nAll checks passed.\n");
+    return 0;
+}
@@ -0,0 +1,224 @@
+/* testBatchThreads - test that TFN_batch gives the same results for one and many threads.
+ *
+ * Synthetic forcing and head CSV files are created for a set of bores of
+ * differing record lengths and TFN_batch is run twice: with one thread and
+ * with many threads. The bores are read and simulated concurrently in the
+ * second run and so this tests that the reading of the files and the
+ * simulations of the bores are independent of each other. The output file
+ * of each bore must be identical for the two runs, as must the summary (less
+ * the run times). The program exits with a non-zero status if they differ.
+ *
+ * Build (from the HydroSight root folder, after building TFN_batch as per
+ * algorithms/models/TransferNoise/batch/TFN_batch.c):
+      gcc -O2 -o testBatchThreads testing/benchmark/testBatchThreads.c
+ *
+ * Usage:
+      ./testBatchThreads TFN_batch [--bores 16] [--threads 4] [--folder .]
+ *
+ *   --bores    Number of synthetic bores (default 16).
+ *   --threads  Number of threads of the second run (default 4).
+ *   --folder   Folder for the synthetic and output files (default: current folder).
+ *
+ * Author:
+ *   Dr. Tim Peterson, The Department of Infrastructure
+ *   Engineering, The University of Melbourne.
+ *
+ * Date:
+ *   18 Oct 2026
+ */
+
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_LINE_LENGTH 4096
+#define DAYS_PER_YEAR 365
+
+static unsigned long long randomState;
+
+/* Deterministic uniform random numbers in (0,1) using a 64 bit LCG. */
+static double randUniform(void)
+{
+    randomState = randomState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((double) (randomState >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+/* Convert the days since 1 Jan 1970 to the year, month and day. */
+static void civilDate(const long days, int *year, int *month, int *day)
+{
+    const long z = days + 719468, era = (z >= 0 ? z : z - 146096) / 146097;
+    const long doe = z - era * 146097;
+    const long yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+    const long doy = doe - (365*yoe + yoe/4 - yoe/100);
+    const long mp = (5*doy + 2)/153;
+    *day = (int) (doy - (153*mp + 2)/5 + 1);
+    *month = (int) (mp < 10 ? mp + 3 : mp - 9);
+    *year = (int) (yoe + era * 400 + (*month <= 2));
+}
+
+/* Write the forcing and head files of a bore. The head is weekly and varies
+ * with the rainfall of the prior weeks. */
+static int writeBoreFiles(const char *forcingFile, const char *headFile, const int nYears, const unsigned long long seed)
+{
+    FILE *fForcing, *fHead;
+    const int nDays = nYears * DAYS_PER_YEAR;
+    const long start = 7305;    /* 1 Jan 1990 */
+    double season, precip, recharge = 0.0;
+    int i, year, month, day;
+
+    fForcing = fopen(forcingFile, "w");
+    fHead = fopen(headFile, "w");
+    if (fForcing == NULL || fHead == NULL) {
+        if (fForcing != NULL) fclose(fForcing);
+        if (fHead != NULL) fclose(fHead);
+        return 0;
+    }
+
+    randomState = seed;
+    fprintf(fForcing, "year,month,day,precip,et\n");
+    fprintf(fHead, "year,month,day,head\n");
+    for (i = 0; i < nDays; i++) {
+        civilDate(start + i, &year, &month, &day);
+        season = sin(6.283185307179586 * (double) i / DAYS_PER_YEAR);
+        precip = randUniform() < 0.3 - 0.15 * season ? -6.0 * log(randUniform()) : 0.0;
+        recharge = 0.98 * recharge + 0.02 * precip;
+        fprintf(fForcing, "%d,%d,%d,%.2f,%.2f\n", year, month, day, precip, 3.0 + 2.5 * season);
+        if (i > 30 && i % 7 == 0)
+            fprintf(fHead, "%d,%d,%d,%.3f\n", year, month, day, 100.0 + recharge + 0.05 * (randUniform() - 0.5));
+    }
+    fclose(fForcing);
+    fclose(fHead);
+    return 1;
+}
+
+/* Write the parameter file of the bores. The outputs are prefixed by the run name. */
+static int writeParameterFile(const char *fileName, const char *runName, const int nBores)
+{
+    FILE *fid = fopen(fileName, "w");
+    int i;
+
+    if (fid == NULL)
+        return 0;
+    for (i = 0; i < nBores; i++) {
+        fprintf(fid, "[bore B%d]\n", i + 1);
+        fprintf(fid, "forcing = threadTest_forcing%d.csv\n", i + 1);
+        fprintf(fid, "head = threadTest_head%d.csv\n", i + 1);
+        fprintf(fid, "output = threadTest_%s_%d.csv\n", runName, i + 1);
+        fprintf(fid, "soil = SMSC 150 k_sat 12 alpha 0 beta 3 gamma 1\n");
+        fprintf(fid, "component = drainage Pearsons -2 -2.5 0.3010299957\n");
+        fprintf(fid, "component = evap_gw_potential PearsonsNegative -3 -2.5 -0.3\n");
+        fprintf(fid, "noise_alpha = -1.2\n");
+    }
+    fclose(fid);
+    return 1;
+}
+
+/* Compare two text files. If skipColumn is >=0 then that comma separated
+ * column is ignored. Returns 1 if the files are the same. */
+static int compareFiles(const char *fileName1, const char *fileName2, const int skipColumn)
+{
+    FILE *fid1 = fopen(fileName1, "r"), *fid2 = fopen(fileName2, "r");
+    char line1[MAX_LINE_LENGTH], line2[MAX_LINE_LENGTH], *end1, *end2, *p1, *p2;
+    int isSame = fid1 != NULL && fid2 != NULL, iCol;
+
+    while (isSame) {
+        p1 = fgets(line1, sizeof(line1), fid1);
+        p2 = fgets(line2, sizeof(line2), fid2);
+        if (p1 == NULL || p2 == NULL) {
+            isSame = p1 == p2;
+            break;
+        }
+        if (skipColumn >= 0) {
+            /* Remove the column from each line. */
+            for (iCol = 0; iCol < skipColumn && p1 != NULL; iCol++)
+                p1 = strchr(p1, ',') == NULL ? NULL : strchr(p1, ',') + 1;
+            for (iCol = 0; iCol < skipColumn && p2 != NULL; iCol++)
+                p2 = strchr(p2, ',') == NULL ? NULL : strchr(p2, ',') + 1;
+            if (p1 != NULL && p2 != NULL && (end1 = strchr(p1, ',')) != NULL && (end2 = strchr(p2, ',')) != NULL) {
+                memmove(p1, end1, strlen(end1) + 1);
+                memmove(p2, end2, strlen(end2) + 1);
+            }
+        }
+        isSame = strcmp(line1, line2) == 0;
+    }
+    if (fid1 != NULL) fclose(fid1);
+    if (fid2 != NULL) fclose(fid2);
+    return isSame;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *batchProgram = NULL, *folder = ".";
+    char path[MAX_PATH_LENGTH], path2[MAX_PATH_LENGTH], command[3*MAX_PATH_LENGTH];
+    int i, nBores = 16, nThreads = 4, nFailed = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bores") == 0 && i + 1 < argc)
+            nBores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--folder") == 0 && i + 1 < argc)
+            folder = argv[++i];
+        else if (argv[i][0] != '-' && batchProgram == NULL)
+            batchProgram = argv[i];
+        else {
+            fprintf(stderr, "Usage: %s TFN_batch [--bores n] [--threads n] [--folder name]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (batchProgram == NULL || nBores < 1 || nThreads < 2) {
+        fprintf(stderr, "Usage: %s TFN_batch [--bores n] [--threads n] [--folder name]\n", argv[0]);
+        return 2;
+    }
+
+    /* Create the bores. The record lengths differ so that the threads read
+     * and simulate different bores at the same time. */
+    for (i = 0; i < nBores; i++) {
+        snprintf(path, MAX_PATH_LENGTH, "%s/threadTest_forcing%d.csv", folder, i + 1);
+        snprintf(path2, MAX_PATH_LENGTH, "%s/threadTest_head%d.csv", folder, i + 1);
+        if (!writeBoreFiles(path, path2, 10 + 3 * (i % 7), i + 1)) {
+            fprintf(stderr, "The bore files could not be created within the folder: %s\n", folder);
+            return 2;
+        }
+    }
+
+    /* Simulate the bores with one thread and then many threads. */
+    for (i = 0; i < 2; i++) {
+        snprintf(path, MAX_PATH_LENGTH, "%s/threadTest_%s.ini", folder, i == 0 ? "serial" : "parallel");
+        if (!writeParameterFile(path, i == 0 ? "serial" : "parallel", nBores)) {
+            fprintf(stderr, "The parameter file could not be created: %s\n", path);
+            return 2;
+        }
+        snprintf(command, sizeof(command), "\"%s\" \"%s\" --threads %d --summary \"%s/threadTest_%s_summary.csv\"",
+                batchProgram, path, i == 0 ? 1 : nThreads, folder, i == 0 ? "serial" : "parallel");
+        printf("Running: %s\n", command);
+        fflush(stdout);
+        if (system(command) != 0)
+            printf("  TFN_batch reported failed bores.\n");
+    }
+
+    /* Compare the summaries, less the run time column, and the outputs. */
+    snprintf(path, MAX_PATH_LENGTH, "%s/threadTest_serial_summary.csv", folder);
+    snprintf(path2, MAX_PATH_LENGTH, "%s/threadTest_parallel_summary.csv", folder);
+    if (!compareFiles(path, path2, 7)) {
+        printf("FAILED: the summaries differ (%s and %s).\n", path, path2);
+        nFailed++;
+    }
+    for (i = 0; i < nBores; i++) {
+        snprintf(path, MAX_PATH_LENGTH, "%s/threadTest_serial_%d.csv", folder, i + 1);
+        snprintf(path2, MAX_PATH_LENGTH, "%s/threadTest_parallel_%d.csv", folder, i + 1);
+        if (!compareFiles(path, path2, -1)) {
+            printf("FAILED: the outputs of bore B%d differ (%s and %s).\n", i + 1, path, path2);
+            nFailed++;
+        }
+    }
+
+    if (nFailed > 0) {
+        printf("\n%d of %d checks failed.\n", nFailed, nBores + 1);
+        return 1;
+    }
+    printf("\nAll checks passed. The results of %d bores are the same for 1 and %d threads.\n", nBores, nThreads);
+    return 0;
+}
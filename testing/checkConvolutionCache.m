@@ -0,0 +1,142 @@
+classdef checkConvolutionCache < matlab.unittest.TestCase
+    % Check the cache of component convolutions within doIRFconvolution (see
+    % model_TFN.get_h_star and model_TFN.getConvolutionCacheKey). The cache
+    % must return a hit only for the same key, forcing and time points, must
+    % miss when any of these change, and must be emptied by
+    % calibration_finalise.
+
+    methods(TestMethodSetup)
+        function clearCache(testCase)
+            % Skip the tests if the compiled convolution has no cache.
+            try
+                [~, kernelInfo] = doIRFconvolution([], [], [], [], false, 0);
+                hasCache = isfield(kernelInfo, 'cache') && kernelInfo.cache;
+            catch
+                hasCache = false;
+            end
+            testCase.assumeTrue(hasCache, 'The compiled doIRFconvolution does not have a convolution cache.');
+            doIRFconvolution('cache_clear');
+
+            % Restore the cache capacity (which also clears the cache).
+            stats = doIRFconvolution('cache_stats');
+            testCase.addTeardown(@doIRFconvolution, 'cache_capacity', stats.capacity);
+        end
+    end
+
+    methods(Test)
+        function checkHitMissAndInvalidation(testCase)
+            % Give user update on test being run.
+            disp('TESTING: Checking hits, misses and invalidation of the convolution cache ...');
+
+            key = [1; 2; 3];
+            forcing = (1:100)';
+            indexes = [90, 95, 100];
+            result = [4, 5, 6];
+            doIRFconvolution('cache_put', key, forcing, indexes, 100, result);
+
+            % The same inputs must hit and return the result.
+            testCase.verifyEqual(doIRFconvolution('cache_get', key, forcing, indexes, 100), result, ...
+                'Error: the cached convolution was not returned.');
+
+            % A change to the key, forcing, time point indexes or the last
+            % theta index must miss.
+            testCase.verifyEmpty(doIRFconvolution('cache_get', [1; 2; 4], forcing, indexes, 100), ...
+                'Error: a differing key returned a cached convolution.');
+            forcing_changed = forcing;
+            forcing_changed(50) = forcing_changed(50) + 1e-12;
+            testCase.verifyEmpty(doIRFconvolution('cache_get', key, forcing_changed, indexes, 100), ...
+                'Error: differing forcing returned a cached convolution.');
+            testCase.verifyEmpty(doIRFconvolution('cache_get', key, forcing, [90, 96, 100], 100), ...
+                'Error: differing time points returned a cached convolution.');
+            testCase.verifyEmpty(doIRFconvolution('cache_get', key, forcing, indexes, 99), ...
+                'Error: a differing theta index returned a cached convolution.');
+
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual([stats.hits, stats.misses, stats.entries], [1, 4, 1], ...
+                'Error: the cache hit, miss or entry counts are wrong.');
+
+            % The least recently used entry must be replaced once full.
+            doIRFconvolution('cache_capacity', 2);
+            doIRFconvolution('cache_put', key, forcing, indexes, 100, result);
+            doIRFconvolution('cache_put', [1; 2; 4], forcing, indexes, 100, result + 1);
+            doIRFconvolution('cache_get', key, forcing, indexes, 100);
+            doIRFconvolution('cache_put', [1; 2; 5], forcing, indexes, 100, result + 2);
+            testCase.verifyEqual(doIRFconvolution('cache_get', key, forcing, indexes, 100), result, ...
+                'Error: the most recently used entry was removed from the cache.');
+            testCase.verifyEmpty(doIRFconvolution('cache_get', [1; 2; 4], forcing, indexes, 100), ...
+                'Error: the least recently used entry was not removed from the cache.');
+
+            % Clearing must empty the cache and reset the counts.
+            doIRFconvolution('cache_clear');
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual([stats.hits, stats.misses, stats.entries], [0, 0, 0], ...
+                'Error: the cache was not cleared.');
+            testCase.verifyEmpty(doIRFconvolution('cache_get', key, forcing, indexes, 100), ...
+                'Error: a cleared cache returned a convolution.');
+        end
+
+        function checkModelCache(testCase)
+            % Give user update on test being run.
+            disp('TESTING: Checking the convolution cache of model_TFN ...');
+
+            % Build a model of synthetic data having a Pearsons precip
+            % component and a derived et component.
+            forcingDates = (datenum(1990,1,1):datenum(2009,12,31))';
+            nDays = numel(forcingDates);
+            rng(1);
+            precip = (rand(nDays,1) < 0.3) .* (-6 .* log(rand(nDays,1)));
+            et = 3 + 2.5 .* sin(2 .* pi .* (1:nDays)' ./ 365);
+            forcingData = struct('colnames', {{'year','month','day','PRECIP','APET'}}, ...
+                'data', [year(forcingDates), month(forcingDates), day(forcingDates), precip, et]);
+            headDates = forcingDates(3650:7:end);
+            head = 100 + filter(0.02, [1, -0.98], precip - et./3);
+            obsHead = [year(headDates), month(headDates), day(headDates), head(3650:7:end)];
+            siteCoordinates = {'bore', 0, 0; 'PRECIP', 10, 10; 'APET', 10, 10};
+            modelOptions = {'precip', 'weightingfunction', 'responseFunction_Pearsons'; ...
+                            'precip', 'forcingdata', 'PRECIP'; ...
+                            'et', 'weightingfunction', 'derivedweighting_PearsonsNegativeRescaled'; ...
+                            'et', 'inputcomponent', 'precip'; ...
+                            'et', 'forcingdata', 'APET'};
+            model = HydroSightModel('cache test', 'bore', 'model_TFN', obsHead, 0, forcingData, siteCoordinates, modelOptions);
+            [params, time_points] = calibration_initialise(model.model, datenum(2000,1,1), datenum(2009,12,31));
+
+            % A repeat of the same parameters and time points must hit.
+            objFn = objectiveFunction(params, time_points, model.model);
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual([stats.hits, stats.entries], [0, 2], ...
+                'Error: the first simulation did not add both components to the cache.');
+            objFn_repeat = objectiveFunction(params, time_points, model.model);
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual(stats.hits, 2, 'Error: the repeat simulation did not use the cache.');
+            testCase.verifyEqual(objFn_repeat, objFn, 'Error: the cached simulation differs.');
+
+            % A change to the precip parameter b (which also changes
+            % weight_at_limit) must miss for both components because the et
+            % component is derived from the precip component.
+            param_names = model.model.variables.param_names;
+            iParam = find(strcmp(param_names(:,1), 'precip') & strcmp(param_names(:,2), 'b'), 1);
+            params_changed = params;
+            params_changed(iParam) = params_changed(iParam) + 0.1;
+            objectiveFunction(params_changed, time_points, model.model);
+            stats_changed = doIRFconvolution('cache_stats');
+            testCase.verifyEqual(stats_changed.hits, stats.hits, ...
+                'Error: changed parameters returned a cached convolution.');
+
+            % Returning to the initial parameters must hit, ie the key must
+            % not depend upon the settings of the prior call (eg
+            % weight_at_limit of the Pearsons function).
+            objectiveFunction(params, time_points, model.model);
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual(stats.hits, stats_changed.hits + 2, ...
+                'Error: the initial parameters did not use the cache.');
+
+            % Finalising the calibration must store the counts and empty
+            % the cache.
+            calibration_finalise(model.model, params, false);
+            testCase.verifyGreaterThanOrEqual(model.model.variables.convolutionCacheStats.hits, stats.hits, ...
+                'Error: the cache counts were not stored by calibration_finalise.');
+            stats = doIRFconvolution('cache_stats');
+            testCase.verifyEqual(stats.entries, 0, 'Error: calibration_finalise did not clear the cache.');
+        end
+    end
+end
@@ -0,0 +1,85 @@
+classdef (SharedTestFixtures = {loadHydroSightFixture()}) ...
+        checkDataQualityScreening < matlab.unittest.TestCase
+    % Check that the error flags of the native kernel doDataQualityScreening
+    % equal those of its MATLAB implementation, doErrorChecks, as used by
+    % doDataQualityAnalysis.
+
+    properties (TestParameter)
+        doChecks = {true, false};
+    end
+
+    methods(Test)
+        function compareErrorFlags(testCase, doChecks)
+            % Give user update on test being run.
+            disp('TESTING: Comparing doDataQualityScreening against doErrorChecks ...');
+
+            % Skip the test if the kernel is not compiled.
+            testCase.assumeEqual(exist('doDataQualityScreening','file'), 3, ...
+                'doDataQualityScreening is not compiled.');
+
+            % Bore construction and the plausible head range.
+            boreDepth = 50;
+            surface_elevation = 100;
+            casing_length = 1;
+            construction_date = datenum(2000,1,1);
+            RateofChangeThreshold = 0.2;
+            ConstHeadThreshold = 60;
+            constHeadThreshold_minObs = 3;
+
+            % Build weekly heads with a flat run at the start and the end.
+            rng(1);
+            time = datenum(2000,1,1) + (0:7:7*299)';
+            head = 80 + cumsum(0.05 .* randn(size(time)));
+            head(1:20) = head(20);
+            head(end-14:end) = head(end-14);
+
+            % Add a flat run of too few observations and one too short.
+            head(100:101) = head(99);
+            head(150:156) = head(149);
+
+            % Add rate of change spikes, including one within the flat run at
+            % the end.
+            head([50, 120, 121, 200, 290]) = head([50, 120, 121, 200, 290]) + [5; -4; -4; 3; 2];
+
+            % Add heads below the bore bottom and above the casing.
+            head(60) = surface_elevation - boreDepth - 1;
+            head(220) = surface_elevation + casing_length + 1;
+
+            % Add duplicate dates, including within the flat runs.
+            iDuplicates = [5; 70; 71; 180; 295];
+            time = [time; time(iDuplicates)];
+            head = [head; head(iDuplicates) + [0; 0.01; 0; -0.5; 0]];
+
+            % Add an observation prior to construction and one in the future.
+            time = [time; construction_date - 10; now() + 30];
+            head = [head; 80; 80];
+
+            headData = sortrows([time, head], 1);
+
+            % Get the flags of the kernel and the MATLAB implementation.
+            settings = [doChecks, doChecks, doChecks, doChecks, doChecks, ...
+                construction_date, now(), surface_elevation - boreDepth, surface_elevation + casing_length, ...
+                RateofChangeThreshold, ConstHeadThreshold, constHeadThreshold_minObs];
+            errorFlags = doDataQualityScreening(headData(:,1), headData(:,2), double(settings));
+
+            errorFlags_expected = cell(1,6);
+            [errorFlags_expected{:}] = doErrorChecks(headData, boreDepth, surface_elevation, casing_length, construction_date, ...
+                doChecks, doChecks, doChecks, doChecks, doChecks, RateofChangeThreshold, ConstHeadThreshold, ...
+                constHeadThreshold_minObs);
+
+            % Check each flag.
+            flagNames = {'date', 'duplicate date', 'minimum head', 'maximum head', 'rate of change', 'constant head'};
+            testCase.assertSize(errorFlags, [size(headData,1), 6], 'Error: doDataQualityScreening returned the wrong size.');
+            for i=1:6
+                testCase.verifyEqual(logical(errorFlags(:,i)), logical(errorFlags_expected{i}), ...
+                    ['Error: the ', flagNames{i}, ' flags differ between doDataQualityScreening and doErrorChecks.']);
+            end
+
+            % Check the data exercised the checks.
+            if doChecks
+                testCase.verifyTrue(all(cellfun(@any, errorFlags_expected)), ...
+                    'Error: the test data did not fail each of the checks.');
+            end
+        end
+    end
+end
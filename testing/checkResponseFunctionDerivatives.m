@@ -0,0 +1,50 @@
+classdef checkResponseFunctionDerivatives < matlab.unittest.TestCase
+    % Check the analytical derivatives of the response functions (see
+    % responseFunction_abstract.dtheta_dp) against central differences of
+    % theta(), as undertaken for the tail integrals by
+    % responseFunction_abstract.dIntTheta_dp.
+
+    properties (TestParameter)
+        responseFunction = {'responseFunction_Pearsons', 'responseFunction_PearsonsNegative'};
+        n = {log10(0.5), log10(1.5)};
+    end
+
+    methods(Test)
+        function checkDerivatives(testCase, responseFunction, n)
+            % Give user update on test being run.
+            disp(['TESTING: Checking dtheta_dp for ',responseFunction,' ...']);
+
+            % Build the response function and set the parameters.
+            obj = feval(responseFunction, 'bore', 'forcing', [], {});
+            params = getParameters(obj);
+            params(end) = n;
+            setParameters(obj, params);
+            t = (0:1000)';
+            theta(obj, t);
+
+            % Get the analytical derivatives.
+            dtheta = dtheta_dp(obj, t);
+            testCase.assertSize(dtheta, [size(t,1), size(params,1)], 'Error: dtheta_dp has the wrong number of columns.');
+
+            % Get the central difference derivatives.
+            dtheta_numerical = zeros(size(dtheta));
+            for i=1:size(params,1)
+                delta = 1e-6 * max(1, abs(params(i)));
+
+                params_delta = params;
+                params_delta(i) = params(i) + delta;
+                setParameters(obj, params_delta);
+                theta_upper = theta(obj, t);
+
+                params_delta(i) = params(i) - delta;
+                setParameters(obj, params_delta);
+                dtheta_numerical(:,i) = (theta_upper - theta(obj, t)) ./ (2*delta);
+            end
+            setParameters(obj, params);
+
+            % Check the derivatives.
+            testCase.verifyEqual(dtheta, dtheta_numerical, 'AbsTol', 1e-6 * max(abs(dtheta_numerical(:))), ...
+                'Error: dtheta_dp differs from the central difference derivatives.');
+        end
+    end
+end